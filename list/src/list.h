@@ -1,5 +1,11 @@
 #pragma once
+#include <algorithm>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include <utility>
 
 namespace task {
@@ -7,54 +13,30 @@ namespace task {
     template<class T, class Allocator = std::allocator<T>>
     class list {
     private:
-        struct Node {
-            T data;
-            Node* next;
-            Node* prev;
-
-            Node() : data(value_type()), next(nullptr), prev(nullptr) {}
-
-            Node(const T& data) : data(data), next(nullptr), prev(nullptr) {}
-
-            Node(T&& data) : data(std::move(data)), next(nullptr), prev(nullptr) {}
-
-            Node(Node&& node)
-                : data(std::forward<T>(node.data)), next(std::move(node.next)), prev(std::move(node.prev)) {
-                node.data = nullptr;
-                node.next = nullptr;
-                node.prev = nullptr;
-            }
-
-            Node& operator=(Node&& node) {
-                if (this == &node) {
-                    return *this;
-                }
-                data = std::move(node.data);
-                next = std::move(node.next);
-                prev = std::move(node.prev);
-
-                node.data = nullptr;
-                node.next = nullptr;
-                node.prev = nullptr;
-
-                return *this;
-            }
-
-            bool operator==(const Node& node) {
-                return data == node.data;
-            }
+        // Links of a node. The list embeds one of them as a sentinel that closes the nodes into
+        // a ring: its next is the first node, its prev the last one, and it is end() itself,
+        // so no position needs a null check and end() never allocates.
+        struct NodeBase {
+            NodeBase* next;
+            NodeBase* prev;
+        };
 
-            bool operator!=(const Node& node) {
-                return data != node.data;
-            }
+        struct Node : NodeBase {
+            T data;
 
+            template<class... Args>
+            explicit Node(Args&&... args) : NodeBase(), data(std::forward<Args>(args)...) {}
         };
 
         using allocator_traits = typename std::allocator_traits<Allocator>;
 
-        using node_allocator_type = typename Allocator::template rebind<Node>::other;
+        using node_allocator_type = typename allocator_traits::template rebind_alloc<Node>;
         using node_allocator_traits = typename std::allocator_traits<node_allocator_type>;
 
+        static Node* node(NodeBase* base) {
+            return static_cast<Node*>(base);
+        }
+
     public:
         using value_type = T;
         using allocator_type = Allocator;
@@ -70,53 +52,29 @@ namespace task {
             "Allocator::value_type must be the same type as value_type"
         );
 
+        template<bool Const>
         class iterator_base {
         public:
             friend class list;
             using value_type = T;
-            using reference = T&;
+            using reference = std::conditional_t<Const, const T&, T&>;
             using difference_type = std::ptrdiff_t;
-            using pointer = T*;
-            using iterator_category = std::random_access_iterator_tag;
+            using pointer = std::conditional_t<Const, const T*, T*>;
+            using iterator_category = std::bidirectional_iterator_tag;
 
         private:
-            Node* ptr;
-            explicit iterator_base(Node* ptr) : ptr(ptr) {}
+            NodeBase* ptr;
+            explicit iterator_base(NodeBase* ptr) : ptr(ptr) {}
 
         public:
-            iterator_base() = delete;
-            iterator_base(const iterator_base& other) = default;
-            iterator_base(iterator_base&& other) noexcept = default;
-
-            iterator_base& operator=(const iterator_base& other) = default;
-            iterator_base& operator=(iterator_base&& other) noexcept = default;
-
-            ~iterator_base() = default;
-
-            reference operator+=(const difference_type n) {
-                Node* result = ptr;
-                if (n > 0) {
-                    for (difference_type i(0); i < n; ++i) {
-                        ptr = ptr->next;
-                    }
-                } else {
-                    for (difference_type i(0); i < (-1) * n; ++i) {
-                        ptr = ptr->prev;
-                    }
-                }
-                return ptr->data;
-            }
+            iterator_base() : ptr(nullptr) {}
 
-            reference operator-=(const difference_type n) {
-                reference result = ptr;
-                for (difference_type i(0); i < n; ++i) {
-                    ptr = ptr->prev;
-                }
-                return ptr->data;
-            }
+            // iterator converts to const_iterator, not the other way round.
+            template<bool OtherConst, class = std::enable_if_t<Const && !OtherConst>>
+            iterator_base(const iterator_base<OtherConst>& other) : ptr(other.ptr) {}
 
-            reference operator*() const { return ptr->data; }
-            pointer operator->() { return &(ptr->data); }
+            reference operator*() const { return node(ptr)->data; }
+            pointer operator->() const { return &node(ptr)->data; }
 
             iterator_base& operator++() {
                 ptr = ptr->next;
@@ -137,251 +95,363 @@ namespace task {
                 return t;
             }
 
-            iterator_base operator-(const difference_type n) {
-                reference result = ptr;
-                for (difference_type i(0); i < n; ++i) {
-                    result = result->prev;
-                }
-                return iterator_base(result);
-            }
-            difference_type operator-(const iterator_base& other) {
-                difference_type result(0);
-                Node* buffer = ptr;
-                while (buffer && buffer != other.ptr) {
-                    ++result;
-                    buffer = buffer->prev;
-                }
-                return result;
-            }
+            friend bool operator==(const iterator_base& left, const iterator_base& right) { return left.ptr == right.ptr; }
+            friend bool operator!=(const iterator_base& left, const iterator_base& right) { return left.ptr != right.ptr; }
+
+        private:
+            template<bool>
+            friend class iterator_base;
+        };
 
-            bool operator<(const iterator_base& other) { return *this != other; }
+        using iterator = iterator_base<false>;
+        using const_iterator = iterator_base<true>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-            bool operator==(const iterator_base& other) { return ptr == (other.ptr); }
-            bool operator!=(const iterator_base& other) { return ptr != (other.ptr); }
+    private:
 
+        // Nodes come from slabs: blocks of node slots taken from the allocator in one call,
+        // growing geometrically up to MAX_SLAB_NODES. The first slot of a block holds its Slab
+        // header, new nodes are carved from the newest block, and destroyed ones go to a free
+        // list for reuse, so insert/erase churn stays off the system allocator.
+        //
+        // The blocks belong to an Arena created with the first node. Lists that exchange nodes
+        // through splice or merge join their arenas, so a node keeps its slot whichever list it
+        // ends up in, and the blocks go back to the allocator when the last of those lists
+        // dies. Lists sharing an arena must not be modified concurrently.
+        struct Slab {
+            Slab* next;
+            size_type capacity;
         };
 
-        using iterator = iterator_base;
-        using const_iterator = iterator_base;
-        using reverse_iterator = std::reverse_iterator<iterator_base>;
-        using const_reverse_iterator = std::reverse_iterator<iterator_base>;
+        struct FreeNode {
+            FreeNode* next;
+        };
 
-    private:
+        // A joined arena hands its blocks to the other one and points to it through parent,
+        // as in a union-find forest. users counts the lists and joined arenas pointing here.
+        struct Arena {
+            Arena* parent;
+            size_type users;
+            Slab* slabs;
+            Slab* lastSlab;
+            FreeNode* freeNodes;
+            FreeNode* lastFree;
+            Node* cursor;
+            Node* end;
+            size_type nextCapacity;
+        };
+
+        using arena_allocator_type = typename allocator_traits::template rebind_alloc<Arena>;
+        using arena_allocator_traits = typename std::allocator_traits<arena_allocator_type>;
+
+        static constexpr size_type MIN_SLAB_NODES = 8;
+        static constexpr size_type MAX_SLAB_NODES = std::max<size_type>(MIN_SLAB_NODES, 65536 / sizeof(Node));
 
         node_allocator_type nodeAllocator;
 
-        Node* first;
-        Node* last;
-        Node* head;
-        Node* tail;
+        NodeBase sentinel;
         size_type listSize;
 
-        void destroy(Node* buffer) {
-            node_allocator_traits::destroy(nodeAllocator, buffer);
-            node_allocator_traits::deallocate(nodeAllocator, buffer, sizeof(Node));
-            buffer = nullptr;
+        Arena* arena;
+
+        // The root of this list's arena, created on first use. Points arena straight at it.
+        Arena* currentArena() {
+            if (!arena) {
+                arena_allocator_type arenaAllocator(nodeAllocator);
+                arena = arena_allocator_traits::allocate(arenaAllocator, 1);
+                ::new (static_cast<void*>(arena)) Arena{nullptr, 1, nullptr, nullptr, nullptr, nullptr,
+                                                        nullptr, nullptr, MIN_SLAB_NODES};
+            } else if (arena->parent) {
+                Arena* root = arena->parent;
+                while (root->parent) {
+                    root = root->parent;
+                }
+                ++root->users;
+                releaseArena(arena);
+                arena = root;
+            }
+            return arena;
+        }
+
+        // Drops one user of target, freeing every arena and block that is left without users.
+        void releaseArena(Arena* target) {
+            while (target && --target->users == 0) {
+                Arena* parent = target->parent;
+                while (target->slabs) {
+                    Slab* next = target->slabs->next;
+                    node_allocator_traits::deallocate(nodeAllocator, reinterpret_cast<Node*>(target->slabs),
+                                                      target->slabs->capacity);
+                    target->slabs = next;
+                }
+                arena_allocator_type arenaAllocator(nodeAllocator);
+                arena_allocator_traits::deallocate(arenaAllocator, target, 1);
+                target = parent;
+            }
         }
 
-        Node* create(Node* buffer) {
-            buffer = node_allocator_traits::allocate(nodeAllocator, sizeof(Node));
-            node_allocator_traits::construct(nodeAllocator, buffer);
-            return buffer;
+        // Makes this list and other allocate from one arena before nodes move between them.
+        // O(1) apart from the root lookups. Needs equal allocators, as splice does for std::list.
+        void shareArena(list& other) {
+            Arena* root = currentArena();
+            Arena* joined = other.currentArena();
+            if (root == joined) {
+                return;
+            }
+            if (joined->slabs) {
+                joined->lastSlab->next = root->slabs;
+                if (!root->slabs) {
+                    root->lastSlab = joined->lastSlab;
+                }
+                root->slabs = joined->slabs;
+            }
+            if (joined->freeNodes) {
+                joined->lastFree->next = root->freeNodes;
+                if (!root->freeNodes) {
+                    root->lastFree = joined->lastFree;
+                }
+                root->freeNodes = joined->freeNodes;
+            }
+            if (root->cursor == root->end) {
+                root->cursor = joined->cursor;
+                root->end = joined->end;
+            }
+            root->nextCapacity = std::max(root->nextCapacity, joined->nextCapacity);
+            joined->slabs = joined->lastSlab = nullptr;
+            joined->freeNodes = joined->lastFree = nullptr;
+            joined->cursor = joined->end = nullptr;
+            joined->parent = root;
+            ++root->users;
+            other.currentArena();
+        }
+
+        Node* takeNode() {
+            Arena* pool = currentArena();
+            if (pool->freeNodes) {
+                Node* buffer = reinterpret_cast<Node*>(pool->freeNodes);
+                pool->freeNodes = pool->freeNodes->next;
+                if (!pool->freeNodes) {
+                    pool->lastFree = nullptr;
+                }
+                return buffer;
+            }
+            if (pool->cursor == pool->end) {
+                const size_type capacity = pool->nextCapacity;
+                Node* block = node_allocator_traits::allocate(nodeAllocator, capacity);
+                pool->slabs = ::new (static_cast<void*>(block)) Slab{pool->slabs, capacity};
+                if (!pool->lastSlab) {
+                    pool->lastSlab = pool->slabs;
+                }
+                pool->cursor = block + 1;
+                pool->end = block + capacity;
+                pool->nextCapacity = std::min(2 * capacity, MAX_SLAB_NODES);
+            }
+            return pool->cursor++;
         }
 
-        template<class ...Args>
-        Node* create(Node* buffer, Args& ...args) {
-            buffer = node_allocator_traits::allocate(nodeAllocator, sizeof(Node));
-            node_allocator_traits::construct(nodeAllocator, buffer, args...);
-            return buffer;
+        void giveBack(Node* buffer) {
+            Arena* pool = currentArena();
+            FreeNode* slot = ::new (static_cast<void*>(buffer)) FreeNode{pool->freeNodes};
+            if (!pool->freeNodes) {
+                pool->lastFree = slot;
+            }
+            pool->freeNodes = slot;
+        }
+
+        void destroy(Node* buffer) {
+            node_allocator_traits::destroy(nodeAllocator, buffer);
+            giveBack(buffer);
         }
 
         template<class ...Args>
-        Node* create(Node* buffer, Args&& ...args) {
-            buffer = node_allocator_traits::allocate(nodeAllocator, sizeof(Node));
-            node_allocator_traits::construct(nodeAllocator, buffer, std::forward<Args>(args)...);
+        Node* create(Args&& ...args) {
+            Node* buffer = takeNode();
+            try {
+                node_allocator_traits::construct(nodeAllocator, buffer, std::forward<Args>(args)...);
+            } catch (...) {
+                giveBack(buffer);
+                throw;
+            }
             return buffer;
         }
 
-        void destroy() {
-            while (first != nullptr && listSize > 0) {
-                Node* buffer = first;
-                first = first->next;
-                destroy(buffer);
-                --listSize;
-            }
-            tail = nullptr;
-            first = last = nullptr;
+        // Inserts node before pos.
+        void link(NodeBase* pos, NodeBase* node) {
+            node->next = pos;
+            node->prev = pos->prev;
+            pos->prev->next = node;
+            pos->prev = node;
+            ++listSize;
         }
 
-        void copy(const list& other) {
-            listSize = other.listSize;
-            Node* buffer;
-            if (listSize > 0) {
-                last = first = node_allocator_traits::allocate(nodeAllocator, sizeof(Node));
-                node_allocator_traits::construct(nodeAllocator, last, other.first->data);
-                buffer = other.first->next;
-            }
-            for (size_type i(1); i < listSize; ++i) {
-                last->next = create(last->next, buffer->data);
+        void unlink(NodeBase* node) {
+            node->prev->next = node->next;
+            node->next->prev = node->prev;
+            --listSize;
+        }
 
-                Node* bufferForLast = last;
-                last = last->next;
-                last->prev = bufferForLast;
+        // Moves [first, last] (inclusive, non-empty) before pos; the caller fixes the sizes.
+        static void transfer(NodeBase* pos, NodeBase* first, NodeBase* last) {
+            first->prev->next = last->next;
+            last->next->prev = first->prev;
+            first->prev = pos->prev;
+            last->next = pos;
+            pos->prev->next = first;
+            pos->prev = last;
+        }
 
-                buffer = buffer->next;
-            }
+        void reset() {
+            sentinel.next = sentinel.prev = &sentinel;
+            listSize = 0;
         }
 
-        void move(list&& other) {
-            listSize = other.listSize;
-            first = std::move(std::forward<Node*>(other.first));
-            Node* buffer = first;
-            for (size_type i(1); i < listSize; ++i) {
-                buffer = buffer->next;
+        // Points the first and last nodes back at this list's sentinel after it was copied.
+        void adoptNodes() {
+            if (listSize == 0) {
+                reset();
+            } else {
+                sentinel.next->prev = &sentinel;
+                sentinel.prev->next = &sentinel;
             }
-            last = buffer;
-            other.first = nullptr;
-            other.last = nullptr;
-            other.listSize = 0;
         }
 
-    public:
-
-        list() :
-            first(nullptr), last(nullptr), listSize(0), nodeAllocator(allocator_type()), tail(nullptr), head(nullptr) {}
+        NodeBase* endNode() const {
+            return const_cast<NodeBase*>(&sentinel);
+        }
 
-        explicit list(const Allocator& alloc) :
-            first(nullptr), last(nullptr), listSize(0), nodeAllocator(alloc), tail(nullptr), head(nullptr) {}
+    public:
 
-        list(size_type count, const T& value, const Allocator& alloc = Allocator()) :
-            listSize(count), nodeAllocator(alloc), tail(nullptr), head(nullptr) {
-            if (count > 0) {
-                last = first = node_allocator_traits::allocate(nodeAllocator, sizeof(Node));
-                node_allocator_traits::construct(nodeAllocator, last, value);
-            }
-            for (size_type i(1); i < listSize; ++i) {
-                last->next = create(last->next, value);
+        list() : list(Allocator()) {}
 
-                Node* buffer = last;
-                last = last->next;
-                last->prev = buffer;
-            }
+        explicit list(const Allocator& alloc) : nodeAllocator(alloc), sentinel(), listSize(0), arena(nullptr) {
+            reset();
         }
 
-        explicit list(size_type count, const Allocator& alloc = Allocator()) :
-            listSize(count), nodeAllocator(alloc), tail(nullptr), head(nullptr) {
-            if (count > 0) {
-                last = first = node_allocator_traits::allocate(nodeAllocator, sizeof(Node));
-                node_allocator_traits::construct(nodeAllocator, last);
+        list(size_type count, const T& value, const Allocator& alloc = Allocator()) : list(alloc) {
+            for (size_type i(0); i < count; ++i) {
+                emplace_back(value);
             }
-            for (size_type i(1); i < count; ++i) {
-                last->next = create(last->next);
+        }
 
-                Node* buffer = last;
-                last = last->next;
-                last->prev = buffer;
+        explicit list(size_type count, const Allocator& alloc = Allocator()) : list(alloc) {
+            for (size_type i(0); i < count; ++i) {
+                emplace_back();
             }
         }
 
         ~list() {
-            destroy();
+            clear();
+            releaseArena(arena);
         }
 
-        list(const list& other) {
-            copy(other);
+        list(const list& other)
+            : list(allocator_traits::select_on_container_copy_construction(other.get_allocator())) {
+            for (const T& value : other) {
+                emplace_back(value);
+            }
         }
 
-        list(list&& other) {
-            move(std::forward<list>(other));
+        list(list&& other)
+            : nodeAllocator(std::move(other.nodeAllocator)), sentinel(other.sentinel), listSize(other.listSize),
+              arena(other.arena) {
+            adoptNodes();
+            other.reset();
+            other.arena = nullptr;
         }
 
         list& operator=(const list& other) {
             if (this == &other) {
                 return *this;
             }
-            destroy();
-            copy(other);
-
+            clear();
+            for (const T& value : other) {
+                emplace_back(value);
+            }
             return *this;
         }
 
         list& operator=(list&& other) {
-            destroy();
-            move(std::forward<list>(other));
-
+            if (this == &other) {
+                return *this;
+            }
+            clear();
+            releaseArena(arena);
+            nodeAllocator = std::move(other.nodeAllocator);
+            sentinel = other.sentinel;
+            listSize = other.listSize;
+            arena = other.arena;
+            adoptNodes();
+            other.reset();
+            other.arena = nullptr;
             return *this;
         }
 
         Allocator get_allocator() const {
-            return nodeAllocator;
+            return Allocator(nodeAllocator);
         }
 
         T& front() {
-            return first->data;
+            return node(sentinel.next)->data;
         }
 
         const T& front() const {
-            return first->data;
+            return node(sentinel.next)->data;
         }
 
         T& back() {
-            return last->data;
+            return node(sentinel.prev)->data;
         }
 
         const T& back() const {
-            return last->data;
+            return node(sentinel.prev)->data;
         }
 
         iterator begin() {
-            return iterator(first);
+            return iterator(sentinel.next);
+        }
+
+        const_iterator begin() const {
+            return const_iterator(sentinel.next);
         }
 
         iterator end() {
-            if (!tail) {
-                tail = create(tail);
-                tail->prev = last;
-                last->next = tail;
-            }
-            return iterator(tail);
+            return iterator(&sentinel);
+        }
+
+        const_iterator end() const {
+            return const_iterator(endNode());
         }
 
         const_iterator cbegin() const {
-            return const_iterator(first);
+            return begin();
         }
 
         const_iterator cend() const {
-            if (!tail) {
-                tail = create(tail);
-                tail->prev = last;
-                last->next = tail;
-            }
-            return const_iterator(tail);
+            return end();
         }
 
         reverse_iterator rbegin() {
-            return reverse_iterator(last);
+            return reverse_iterator(end());
+        }
+
+        const_reverse_iterator rbegin() const {
+            return const_reverse_iterator(end());
         }
 
         reverse_iterator rend() {
-            if (!head) {
-                head = create(head);
-                head->next = first;
-                first->next = head;
-            }
-            return reverse_iterator(head);
+            return reverse_iterator(begin());
         }
 
-        const_reverse_iterator crbegin() {
-            if (!tail) {
-                tail = create(tail);
-                tail->prev = last;
-                last->next = tail;
-            }
-            return const_reverse_iterator(iterator_base(tail));
+        const_reverse_iterator rend() const {
+            return const_reverse_iterator(begin());
         }
 
-        const_reverse_iterator crend() {
-            return const_reverse_iterator(iterator_base(first));
+        const_reverse_iterator crbegin() const {
+            return rbegin();
+        }
+
+        const_reverse_iterator crend() const {
+            return rend();
         }
 
         bool empty() const {
@@ -393,400 +463,303 @@ namespace task {
         }
 
         size_t max_size() const {
-            //??
-            return SIZE_MAX;
+            return std::min<size_t>(node_allocator_traits::max_size(nodeAllocator),
+                                    std::numeric_limits<difference_type>::max());
         }
 
         void clear() {
-            destroy();
-        }
-
-        iterator insert(iterator it, const value_type& value) {
-            Node* buffer = it.ptr;
-            if (buffer->next) {
-                if (buffer->prev) {
-                    Node* newPrev = nullptr;
-                    newPrev = create(newPrev, value);
-                    buffer->prev->next = newPrev;
-                    newPrev->prev = buffer->prev;
-                    buffer->prev = newPrev;
-                    newPrev->next = buffer;
-                    it.ptr = buffer;
-                } else {
-                    buffer->prev = create(buffer->prev, value);
-                    first = buffer->prev;
-                    first->next = buffer;
-                }
-            } else {
-                buffer->data = value;
-                last = tail;
-                tail = nullptr;
-                tail = create(tail);
-                tail->prev = last;
-                last->next = tail;
+            NodeBase* buffer = sentinel.next;
+            while (buffer != &sentinel) {
+                NodeBase* next = buffer->next;
+                destroy(node(buffer));
+                buffer = next;
             }
-            ++listSize;
-            return it;
-        }
-
-        iterator insert(iterator it, value_type&& value) {
-            Node* buffer = it.ptr;
-            if (buffer) {
-                if (buffer->prev) {
-                    Node* newPrev = nullptr;
-                    newPrev = create(newPrev, std::forward<T>(value));
-                    buffer->prev->next = newPrev;
-                    newPrev->prev = buffer->prev;
-                    buffer->prev = newPrev;
-                    newPrev->next = buffer;
-                    it.ptr = buffer;
-                } else {
-                    buffer->prev = create(buffer->prev, std::forward<T>(value));
-                    first->prev = buffer->prev;
-                    first = buffer->prev;
-                    first->next = buffer;
-                }
-            } else {
-                buffer->data = std::forward<value_type>(value);
-                last = tail;
-                tail = nullptr;
-            }
-            ++listSize;
-            return it;
+            reset();
         }
 
-        iterator insert(iterator it, size_type count, const T& value) {
-            for (size_type i(0); i < count; ++i) {
-                insert(it, value);
-            }
-            return it;
+        iterator insert(const_iterator pos, const value_type& value) {
+            return emplace(pos, value);
         }
 
-        iterator erase(iterator it) {
-            Node* buffer = it.ptr;
-            if (buffer) {
-                if (buffer->next) {
-                    buffer->next->prev = buffer->prev;
-                } else {
-                    last = last->prev;
-                }
-                if (buffer->prev) {
-                    buffer->prev->next = buffer->next;
-                } else {
-                    first = first->next;
-                }
-                destroy(buffer);
-                --listSize;
-            }
-            return it;
+        iterator insert(const_iterator pos, value_type&& value) {
+            return emplace(pos, std::move(value));
         }
 
-        iterator erase(iterator first, iterator last) {
-            iterator it = first;
-            while (true) {
-                if (it.ptr) {
-                    iterator bufferIt(it.ptr->next);
-                    erase(it);
-                    it = bufferIt;
-                } else {
-                    break;
-                }
-                if (it == last) {
-                    break;
+        iterator insert(const_iterator pos, size_type count, const T& value) {
+            iterator result(pos.ptr);
+            for (size_type i(0); i < count; ++i) {
+                iterator inserted = emplace(pos, value);
+                if (i == 0) {
+                    result = inserted;
                 }
             }
-            return first;
+            return result;
         }
 
-        void push_back(const T& value) {
-            if (listSize > 0) {
-                last->next = create(last->next, value);
+        iterator erase(const_iterator pos) {
+            NodeBase* next = pos.ptr->next;
+            unlink(pos.ptr);
+            destroy(node(pos.ptr));
+            return iterator(next);
+        }
 
-                Node* buffer = last;
-                last = last->next;
-                last->prev = buffer;
-            } else {
-                first = last = node_allocator_traits::allocate(nodeAllocator, sizeof(Node));
-                node_allocator_traits::construct(nodeAllocator, last, value);
+        iterator erase(const_iterator first, const_iterator last) {
+            while (first != last) {
+                first = erase(first);
             }
-            ++listSize;
+            return iterator(last.ptr);
         }
 
-        void push_back(T&& value) {
-            if (listSize > 0) {
-                last->next = create(last->next, std::forward<T>(value));
+        void push_back(const T& value) {
+            emplace_back(value);
+        }
 
-                Node* buffer = last;
-                last = last->next;
-                last->prev = buffer;
-            } else {
-                first = last = node_allocator_traits::allocate(nodeAllocator, sizeof(Node));
-                node_allocator_traits::construct(nodeAllocator, last, std::forward<T>(value));
-            }
-            ++listSize;
+        void push_back(T&& value) {
+            emplace_back(std::move(value));
         }
 
         void pop_back() {
-            if (listSize > 0) {
-                Node* buffer = last;
-                last = last->prev;
-                destroy(buffer);
-                --listSize;
-            }
-            if (listSize == 0) {
-                first = last = nullptr;
-            }
+            erase(const_iterator(sentinel.prev));
         }
 
         void push_front(const T& value) {
-            if (listSize > 0) {
-                first->prev = create(first->prev, value);
-
-                Node* buffer = first;
-                first = first->prev;
-                first->next = buffer;
-            } else {
-                first = last = node_allocator_traits::allocate(nodeAllocator, sizeof(Node));
-                node_allocator_traits::construct(nodeAllocator, last, value);
-            }
-            ++listSize;
+            emplace_front(value);
         }
 
         void push_front(T&& value) {
-            if (listSize > 0) {
-                first->prev = create(first->prev, std::forward<T>(value));
-
-                Node* buffer = first;
-                first = first->prev;
-                first->next = buffer;
-            } else {
-                first = last = node_allocator_traits::allocate(nodeAllocator, sizeof(Node));
-                node_allocator_traits::construct(nodeAllocator, last, std::forward<T>(value));
-            }
-            ++listSize;
+            emplace_front(std::move(value));
         }
 
         void pop_front() {
-            if (listSize > 0) {
-                Node* buffer = first;
-                first = first->next;
-                destroy(buffer);
-                --listSize;
-            }
+            erase(const_iterator(sentinel.next));
         }
 
         template<class... Args>
         iterator emplace(const_iterator pos, Args&& ... args) {
-            Node* buffer = pos.it.ptr;
-            if (buffer) {
-                Node* bufferPrev = buffer->prev;
-                Node* bufferNext = buffer->next;
-                destroy(buffer);
-                buffer = create(buffer, std::forward<Args>(args)...);
-                buffer->prev = bufferPrev;
-                buffer->next = bufferNext;
-                if (bufferPrev) {
-                    bufferPrev->next = buffer;
-                }
-                if (bufferNext) {
-                    bufferNext->prev = buffer;
-                }
-            }
+            Node* buffer = create(std::forward<Args>(args)...);
+            link(pos.ptr, buffer);
+            return iterator(buffer);
         }
 
-        //wtf constructor????
         template<class... Args>
-        void emplace_back(Args&& ... args) {
-            if (listSize > 0) {
-                last->next = create(last->next, std::forward<Args>(args)...);
-
-                Node* buffer = last;
-                last = last->next;
-                last->prev = buffer;
-            } else {
-                first = last = node_allocator_traits::allocate(nodeAllocator, sizeof(Node));
-                node_allocator_traits::construct(nodeAllocator, last, std::forward<Args>(args)...);
-            }
-            ++listSize;
+        T& emplace_back(Args&& ... args) {
+            return *emplace(cend(), std::forward<Args>(args)...);
         }
 
         template<class... Args>
-        void emplace_front(Args&& ... args) {
-            if (listSize > 0) {
-                first->prev = create(last->next, std::forward<Args>(args)...);
-
-                Node* buffer = first;
-                first = first->prev;
-                first->next = buffer;
-            } else {
-                first = last = node_allocator_traits::allocate(nodeAllocator, sizeof(Node));
-                node_allocator_traits::construct(nodeAllocator, last, std::forward<Args>(args)...);
-            }
-            ++listSize;
-
+        T& emplace_front(Args&& ... args) {
+            return *emplace(cbegin(), std::forward<Args>(args)...);
         }
 
         void resize(size_type count) {
-            if (count > listSize) {
-                for (size_type i(listSize); i < count; ++i) {
-                    push_back(value_type());
-                }
-            } else {
-                if (count < listSize) {
-                    size_type bufferSize = listSize;
-                    for (size_type i(count); i < bufferSize; ++i) {
-                        pop_back();
-                    }
-                }
+            while (listSize > count) {
+                pop_back();
+            }
+            while (listSize < count) {
+                emplace_back();
             }
         }
 
         void swap(list& other) {
-            std::swap(listSize, other.listSize);
-            std::swap(first, other.first);
-            Node* buffer = first;
-            for (size_type i(1); i < listSize; ++i) {
-                buffer = buffer->next;
-            }
-            last = buffer;
-            buffer = other.first;
-            for (size_type i(1); i < other.listSize; ++i) {
-                buffer = buffer->next;
+            if (this == &other) {
+                return;
             }
-            other.last = buffer;
+            std::swap(nodeAllocator, other.nodeAllocator);
+            std::swap(sentinel, other.sentinel);
+            std::swap(listSize, other.listSize);
+            adoptNodes();
+            other.adoptNodes();
+            std::swap(arena, other.arena);
         }
 
         void merge(list& other) {
-            if (this == &other)
-                return;
-
-            Node* newFirst = nullptr;
-            Node* newLast = nullptr;
-            Node* bufferThis = first;
-            Node* bufferOther = other.first;
-            if (bufferThis || bufferOther) {
-                if (bufferThis) {
-                    newLast = newFirst = create(newFirst);
-                    newFirst->data = bufferThis->data;
-                    bufferThis = bufferThis->next;
-                } else { // if (bufferOther)
-                    newLast = newFirst = create(newFirst);
-                    newFirst->data = bufferOther->data;
-                    bufferOther = bufferOther->next;
-                }
-            }
+            merge(other, std::less<value_type>());
+        }
 
-            while (bufferThis || bufferOther) {
-                newLast->next = create(newLast->next);
-                if (bufferThis && bufferOther) {
-                    if (bufferThis->data <= bufferOther->data) {
-                        newLast->next->data = bufferThis->data;
-                        bufferThis = bufferThis->next;
-                    } else {
-                        newLast->next->data = bufferOther->data;
-                        bufferOther = bufferOther->next;
-                    }
-                } else if (bufferThis) {
-                    newLast->next->data = bufferThis->data;
-                    bufferThis = bufferThis->next;
-                } else { // if (bufferOther)
-                    newLast->next->data = bufferOther->data;
-                    bufferOther = bufferOther->next;
-                }
-                newLast = newLast->next;
+        // Relinks the nodes of other into this list; on ties the elements of this list come
+        // first. Both lists must be sorted by comp. No element is copied or allocated.
+        template<class Compare>
+        void merge(list& other, Compare comp) {
+            if (this == &other || other.listSize == 0) {
+                return;
             }
+            shareArena(other);
+            NodeBase* merged = mergeChains(detachAll(), other.detachAll(), comp);
+            listSize += other.listSize;
+            other.reset();
+            relink(merged);
         }
 
+        // Moves all elements of other before pos in O(1).
         void splice(const_iterator pos, list& other) {
-            Node* buffer = pos.ptr;
-
-            if (buffer && other.listSize > 0) {
-                Node* bufferPrev = buffer->prev;
-                buffer->prev = other.last;
-                other.last->next = buffer;
-                bufferPrev->next = other.first;
-                other.first->prev = bufferPrev;
+            if (this == &other || other.listSize == 0) {
+                return;
+            }
+            shareArena(other);
+            transfer(pos.ptr, other.sentinel.next, other.sentinel.prev);
+            listSize += other.listSize;
+            other.reset();
+        }
 
-                other.listSize = 0;
-                other.first = nullptr;
-                other.last = nullptr;
+        // Moves the element at it from other before pos in O(1); the node itself is relinked.
+        void splice(const_iterator pos, list& other, const_iterator it) {
+            if (pos == it || pos.ptr == it.ptr->next) {
+                return;
+            }
+            if (this != &other) {
+                shareArena(other);
+                --other.listSize;
+                ++listSize;
             }
+            transfer(pos.ptr, it.ptr, it.ptr);
         }
 
         void remove(const T& value) {
-            Node* buffer;
-            while (buffer != nullptr) {
-                if (buffer->data == value) {
-                    if (buffer->prev != nullptr) {
-                        buffer->prev->next = buffer->next;
-                    }
-                    if (buffer->next != nullptr) {
-                        buffer->next->prev = buffer->prev;
+            // value may be one of the elements, so that node goes last.
+            NodeBase* deferred = nullptr;
+            NodeBase* buffer = sentinel.next;
+            while (buffer != &sentinel) {
+                NodeBase* next = buffer->next;
+                if (node(buffer)->data == value) {
+                    if (&node(buffer)->data == &value) {
+                        deferred = buffer;
+                    } else {
+                        erase(const_iterator(buffer));
                     }
-                    destroy(buffer);
-                    return;
                 }
-                buffer = buffer->next;
+                buffer = next;
+            }
+            if (deferred) {
+                erase(const_iterator(deferred));
             }
         }
 
         void reverse() {
-            Node* newFirst = nullptr;
-            Node* newLast = nullptr;
-            Node* buffer = first;
-            if (listSize > 0) {
-                newLast = newFirst = create(newFirst, buffer->data);
-                buffer = buffer->next;
+            NodeBase* buffer = &sentinel;
+            do {
+                std::swap(buffer->next, buffer->prev);
+                buffer = buffer->prev;
+            } while (buffer != &sentinel);
+        }
+
+        void unique() {
+            if (listSize < 2) {
+                return;
             }
-            while (buffer != nullptr) {
-                newFirst->prev = create(newFirst->prev, buffer->data);
-                newFirst = newFirst->prev;
-                buffer = buffer->next;
+            NodeBase* buffer = sentinel.next;
+            while (buffer->next != &sentinel) {
+                if (node(buffer)->data == node(buffer->next)->data) {
+                    erase(const_iterator(buffer->next));
+                } else {
+                    buffer = buffer->next;
+                }
             }
+        }
 
-            size_type sizeBuffer = listSize;
-            destroy();
-            listSize = sizeBuffer;
-            first = newFirst;
-            last = newLast;
+        void sort() {
+            sort(std::less<value_type>());
         }
 
-        void unique() {
-            Node* currentLeftNode = first;
-            Node* currentRightNode = nullptr;
-            for (size_type i(0); i < listSize; ++i) {
-                currentRightNode = currentLeftNode->next;
-                for (size_type j(i); j < listSize; ++j) {
-                    if (currentLeftNode->data == currentRightNode->data) {
-                        currentLeftNode->next = currentRightNode->next;
-                        if (currentRightNode->next) {
-                            currentRightNode->next->prev = currentLeftNode;
-                        }
-                        destroy(currentRightNode);
-                        --listSize;
-                        currentRightNode = currentLeftNode->next;
-                    } else {
-                        break;
-                    }
-                    currentRightNode = currentRightNode->next;
+        // Bottom-up natural merge sort: the nodes are cut into ascending runs (strictly
+        // descending ones are reversed) and merged through a binary counter of run lists, so
+        // only the links change. Stable, O(n log n) comparisons and no allocations.
+        template<class Compare>
+        void sort(Compare comp) {
+            if (listSize < 2) {
+                return;
+            }
+            NodeBase* bins[64] = {};
+            NodeBase* rest = detachAll();
+            while (rest) {
+                NodeBase* run = cutRun(rest, comp);
+                size_type i(0);
+                for (; bins[i]; ++i) {
+                    run = mergeChains(bins[i], run, comp);
+                    bins[i] = nullptr;
                 }
-                currentLeftNode = currentLeftNode->next;
+                bins[i] = run;
             }
+            NodeBase* sorted = nullptr;
+            for (NodeBase* bin : bins) {
+                if (bin) {
+                    sorted = sorted ? mergeChains(bin, sorted, comp) : bin;
+                }
+            }
+            relink(sorted);
         }
 
-        void sort() {
-            Node* currentLeftNode = first;
-            Node* currentRightNode = nullptr;
-            for (size_type i(0); i < listSize; ++i) {
-                currentRightNode = currentLeftNode->next;
-                for (size_type j(i + 1); j < listSize; ++j) {
-                    if (currentLeftNode->data > currentRightNode->data) {
-                        std::swap(currentLeftNode->data, currentRightNode->data);
-                    }
-                    currentRightNode = currentRightNode->next;
+    private:
+
+        // Detaches the run starting at rest, advances rest past it and returns the run as a
+        // null-terminated chain in ascending order.
+        template<class Compare>
+        static NodeBase* cutRun(NodeBase*& rest, Compare& comp) {
+            NodeBase* run = rest;
+            NodeBase* end = run;
+            if (end->next && comp(node(end->next)->data, node(end)->data)) {
+                while (end->next && comp(node(end->next)->data, node(end)->data)) {
+                    end = end->next;
+                }
+                rest = end->next;
+                NodeBase* reversed = nullptr;
+                for (NodeBase* buffer = run; buffer != rest;) {
+                    NodeBase* next = buffer->next;
+                    buffer->next = reversed;
+                    reversed = buffer;
+                    buffer = next;
                 }
-                currentLeftNode = currentLeftNode->next;
+                return reversed;
+            }
+            while (end->next && !comp(node(end->next)->data, node(end)->data)) {
+                end = end->next;
+            }
+            rest = end->next;
+            end->next = nullptr;
+            return run;
+        }
+
+        // Merges two sorted null-terminated chains through their next links; on ties the node
+        // from left comes first.
+        template<class Compare>
+        static NodeBase* mergeChains(NodeBase* left, NodeBase* right, Compare& comp) {
+            NodeBase* result = nullptr;
+            NodeBase** link = &result;
+            while (left && right) {
+                if (comp(node(right)->data, node(left)->data)) {
+                    *link = right;
+                    right = right->next;
+                } else {
+                    *link = left;
+                    left = left->next;
+                }
+                link = &(*link)->next;
+            }
+            *link = left ? left : right;
+            return result;
+        }
+
+        // Cuts the nodes out of the ring and returns them as a null-terminated chain (nullptr
+        // for an empty list). listSize is left for the caller.
+        NodeBase* detachAll() {
+            if (listSize == 0) {
+                return nullptr;
+            }
+            NodeBase* chain = sentinel.next;
+            sentinel.prev->next = nullptr;
+            sentinel.next = sentinel.prev = &sentinel;
+            return chain;
+        }
+
+        // Closes the null-terminated chain back into the ring and restores the prev links.
+        void relink(NodeBase* chain) {
+            NodeBase* prev = &sentinel;
+            for (NodeBase* buffer = chain; buffer; buffer = buffer->next) {
+                buffer->prev = prev;
+                prev->next = buffer;
+                prev = buffer;
             }
+            prev->next = &sentinel;
+            sentinel.prev = prev;
         }
 
     };
@@ -0,0 +1,679 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace task {
+
+    // Unrolled variant of list: the elements live in chunks of up to N slots, and the chunks
+    // form a ring closed by an embedded sentinel like the nodes of list. Traversal walks
+    // contiguous slots instead of chasing a pointer per element, and the per-element overhead
+    // is one index byte (two for N > 256) plus the chunk links shared by N elements.
+    //
+    // Every chunk keeps its elements in fixed slots together with a permutation `order` of the
+    // slot indices: order[0, count) lists the occupied slots in sequence order, order[count, N)
+    // the free ones. Inserting or erasing shifts only indices, so elements stay put, and
+    // references and pointers to an element stay valid until it is erased, except when
+    //  - an insertion or a whole-list splice lands inside a chunk that has to be split: the
+    //    shorter side of the split point moves into a new chunk;
+    //  - splice moves a single element into another chunk: that element itself moves, unless
+    //    it is alone in its chunk, which is then relinked;
+    //  - shrink_to_fit packs the elements into as few chunks as possible.
+    // Splitting needs T to be move constructible. Erasing never moves anything and frees a
+    // chunk only once it is empty, so erase churn can leave sparse chunks behind; call
+    // shrink_to_fit to restore the memory per element and the traversal speed.
+    //
+    // Iterators hold a chunk and a position within it, so, as with std::deque, any insertion
+    // or erasure invalidates the iterators into the chunks it touches (end() stays valid).
+    // sort and merge are not provided: both would have to move elements between chunks.
+    template<class T, std::size_t N = 32, class Allocator = std::allocator<T>>
+    class unrolled_list {
+        static_assert(N >= 2 && N <= 65535, "unrolled_list chunks hold between 2 and 65535 elements");
+
+    private:
+        using index_type = std::conditional_t<N <= 256, std::uint8_t, std::uint16_t>;
+
+        struct ChunkBase {
+            ChunkBase* next;
+            ChunkBase* prev;
+            std::size_t count;
+        };
+
+        struct Chunk : ChunkBase {
+            index_type order[N];
+            alignas(T) unsigned char storage[N * sizeof(T)];
+
+            Chunk() : ChunkBase() {
+                for (std::size_t i = 0; i < N; ++i) {
+                    order[i] = static_cast<index_type>(i);
+                }
+            }
+
+            T* slot(std::size_t index) {
+                return std::launder(reinterpret_cast<T*>(storage) + index);
+            }
+
+            // Element at position i of the sequence.
+            T& at(std::size_t i) {
+                return *slot(order[i]);
+            }
+        };
+
+        using allocator_traits = typename std::allocator_traits<Allocator>;
+
+        using chunk_allocator_type = typename allocator_traits::template rebind_alloc<Chunk>;
+        using chunk_allocator_traits = typename std::allocator_traits<chunk_allocator_type>;
+
+        static Chunk* chunk(ChunkBase* base) {
+            return static_cast<Chunk*>(base);
+        }
+
+    public:
+        using value_type = T;
+        using allocator_type = Allocator;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = typename allocator_traits::pointer;
+        using const_pointer = typename allocator_traits::const_pointer;
+
+        static_assert(
+            std::is_same<typename Allocator::value_type, value_type>::value,
+            "Allocator::value_type must be the same type as value_type"
+        );
+
+        template<bool Const>
+        class iterator_base {
+        public:
+            friend class unrolled_list;
+            using value_type = T;
+            using reference = std::conditional_t<Const, const T&, T&>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<Const, const T*, T*>;
+            using iterator_category = std::bidirectional_iterator_tag;
+
+        private:
+            ChunkBase* owner;
+            size_type index;
+            iterator_base(ChunkBase* owner, size_type index) : owner(owner), index(index) {}
+
+        public:
+            iterator_base() : owner(nullptr), index(0) {}
+
+            // iterator converts to const_iterator, not the other way round.
+            template<bool OtherConst, class = std::enable_if_t<Const && !OtherConst>>
+            iterator_base(const iterator_base<OtherConst>& other) : owner(other.owner), index(other.index) {}
+
+            reference operator*() const { return chunk(owner)->at(index); }
+            pointer operator->() const { return &chunk(owner)->at(index); }
+
+            iterator_base& operator++() {
+                if (++index == owner->count) {
+                    owner = owner->next;
+                    index = 0;
+                }
+                return *this;
+            }
+            iterator_base& operator--() {
+                if (index == 0) {
+                    owner = owner->prev;
+                    index = owner->count;
+                }
+                --index;
+                return *this;
+            }
+            iterator_base operator++(int) {
+                iterator_base t(*this);
+                ++*this;
+                return t;
+            }
+            iterator_base operator--(int) {
+                iterator_base t(*this);
+                --*this;
+                return t;
+            }
+
+            friend bool operator==(const iterator_base& left, const iterator_base& right) {
+                return left.owner == right.owner && left.index == right.index;
+            }
+            friend bool operator!=(const iterator_base& left, const iterator_base& right) {
+                return !(left == right);
+            }
+
+        private:
+            template<bool>
+            friend class iterator_base;
+        };
+
+        using iterator = iterator_base<false>;
+        using const_iterator = iterator_base<true>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    private:
+
+        chunk_allocator_type chunkAllocator;
+
+        ChunkBase sentinel;
+        size_type listSize;
+
+        // Allocates an empty chunk and links it before pos.
+        Chunk* createChunk(ChunkBase* pos) {
+            Chunk* buffer = chunk_allocator_traits::allocate(chunkAllocator, 1);
+            ::new (static_cast<void*>(buffer)) Chunk();
+            buffer->next = pos;
+            buffer->prev = pos->prev;
+            pos->prev->next = buffer;
+            pos->prev = buffer;
+            return buffer;
+        }
+
+        void destroyChunk(Chunk* buffer) {
+            buffer->prev->next = buffer->next;
+            buffer->next->prev = buffer->prev;
+            buffer->~Chunk();
+            chunk_allocator_traits::deallocate(chunkAllocator, buffer, 1);
+        }
+
+        // Moves the elements at positions [first, last) of from to position at of to, which
+        // must have room for them.
+        void transferElements(Chunk* from, size_type first, size_type last, Chunk* to, size_type at) {
+            const size_type count = last - first;
+            // Free slots follow the occupied ones in order, so rotating brings count of them to at.
+            std::rotate(to->order + at, to->order + to->count, to->order + to->count + count);
+            for (size_type i(0); i < count; ++i) {
+                T& element = from->at(first + i);
+                chunk_allocator_traits::construct(chunkAllocator, to->slot(to->order[at + i]), std::move(element));
+                chunk_allocator_traits::destroy(chunkAllocator, &element);
+            }
+            to->count += count;
+            std::rotate(from->order + first, from->order + last, from->order + from->count);
+            from->count -= count;
+        }
+
+        // Splits buffer before position at by moving the shorter side into a new chunk.
+        // Returns the chunks holding the elements before and from at.
+        std::pair<Chunk*, Chunk*> split(Chunk* buffer, size_type at) {
+            if (at * 2 >= buffer->count) {
+                Chunk* tail = createChunk(buffer->next);
+                transferElements(buffer, at, buffer->count, tail, 0);
+                return {buffer, tail};
+            }
+            Chunk* head = createChunk(buffer);
+            transferElements(buffer, 0, at, head, 0);
+            return {head, buffer};
+        }
+
+        // The iterator for position index of owner, which may be one past its last element.
+        static iterator position(ChunkBase* owner, size_type index) {
+            return index == owner->count ? iterator(owner->next, 0) : iterator(owner, index);
+        }
+
+        // Destroys the element at position index of buffer; buffer may be left empty.
+        void eraseAt(Chunk* buffer, size_type index) {
+            const index_type freed = buffer->order[index];
+            chunk_allocator_traits::destroy(chunkAllocator, buffer->slot(freed));
+            std::copy(buffer->order + index + 1, buffer->order + buffer->count, buffer->order + index);
+            buffer->order[--buffer->count] = freed;
+            --listSize;
+        }
+
+        // Finds the chunk and position that a new element before pos goes to. The chunk may be
+        // full, in which case the caller splits it.
+        std::pair<Chunk*, size_type> placeBefore(ChunkBase* owner, size_type index) {
+            // Right after the last element of the previous chunk, when it has room: appending
+            // and prepending then fill chunks instead of splitting them.
+            if (index == 0 && owner->prev != &sentinel && owner->prev->count < N) {
+                return {chunk(owner->prev), owner->prev->count};
+            }
+            if (owner == &sentinel || (index == 0 && owner->count == N)) {
+                return {createChunk(owner), 0};
+            }
+            return {chunk(owner), index};
+        }
+
+        template<class... Args>
+        iterator constructAt(Chunk* target, size_type index, Args&& ... args) {
+            const index_type free = target->order[target->count];
+            try {
+                chunk_allocator_traits::construct(chunkAllocator, target->slot(free), std::forward<Args>(args)...);
+            } catch (...) {
+                if (target->count == 0) {
+                    destroyChunk(target);
+                }
+                throw;
+            }
+            std::copy_backward(target->order + index, target->order + target->count, target->order + target->count + 1);
+            target->order[index] = free;
+            ++target->count;
+            ++listSize;
+            return iterator(target, index);
+        }
+
+        // Links the chunks first to last, which are linked to each other, before pos.
+        static void linkBefore(ChunkBase* pos, ChunkBase* first, ChunkBase* last) {
+            first->prev = pos->prev;
+            last->next = pos;
+            pos->prev->next = first;
+            pos->prev = last;
+        }
+
+        void reset() {
+            sentinel.next = sentinel.prev = &sentinel;
+            sentinel.count = 0;
+            listSize = 0;
+        }
+
+        // Points the first and last chunks back at this list's sentinel after it was copied.
+        void adoptChunks() {
+            if (listSize == 0) {
+                reset();
+            } else {
+                sentinel.next->prev = &sentinel;
+                sentinel.prev->next = &sentinel;
+            }
+        }
+
+        ChunkBase* endChunk() const {
+            return const_cast<ChunkBase*>(&sentinel);
+        }
+
+    public:
+
+        unrolled_list() : unrolled_list(Allocator()) {}
+
+        explicit unrolled_list(const Allocator& alloc) : chunkAllocator(alloc), sentinel(), listSize(0) {
+            reset();
+        }
+
+        unrolled_list(size_type count, const T& value, const Allocator& alloc = Allocator()) : unrolled_list(alloc) {
+            for (size_type i(0); i < count; ++i) {
+                emplace_back(value);
+            }
+        }
+
+        explicit unrolled_list(size_type count, const Allocator& alloc = Allocator()) : unrolled_list(alloc) {
+            for (size_type i(0); i < count; ++i) {
+                emplace_back();
+            }
+        }
+
+        ~unrolled_list() {
+            clear();
+        }
+
+        unrolled_list(const unrolled_list& other)
+            : unrolled_list(allocator_traits::select_on_container_copy_construction(other.get_allocator())) {
+            for (const T& value : other) {
+                emplace_back(value);
+            }
+        }
+
+        unrolled_list(unrolled_list&& other)
+            : chunkAllocator(std::move(other.chunkAllocator)), sentinel(other.sentinel), listSize(other.listSize) {
+            adoptChunks();
+            other.reset();
+        }
+
+        unrolled_list& operator=(const unrolled_list& other) {
+            if (this == &other) {
+                return *this;
+            }
+            clear();
+            for (const T& value : other) {
+                emplace_back(value);
+            }
+            return *this;
+        }
+
+        unrolled_list& operator=(unrolled_list&& other) {
+            if (this == &other) {
+                return *this;
+            }
+            clear();
+            chunkAllocator = std::move(other.chunkAllocator);
+            sentinel = other.sentinel;
+            listSize = other.listSize;
+            adoptChunks();
+            other.reset();
+            return *this;
+        }
+
+        Allocator get_allocator() const {
+            return Allocator(chunkAllocator);
+        }
+
+        T& front() {
+            return chunk(sentinel.next)->at(0);
+        }
+
+        const T& front() const {
+            return chunk(sentinel.next)->at(0);
+        }
+
+        T& back() {
+            return chunk(sentinel.prev)->at(sentinel.prev->count - 1);
+        }
+
+        const T& back() const {
+            return chunk(sentinel.prev)->at(sentinel.prev->count - 1);
+        }
+
+        iterator begin() {
+            return iterator(sentinel.next, 0);
+        }
+
+        const_iterator begin() const {
+            return const_iterator(sentinel.next, 0);
+        }
+
+        iterator end() {
+            return iterator(&sentinel, 0);
+        }
+
+        const_iterator end() const {
+            return const_iterator(endChunk(), 0);
+        }
+
+        const_iterator cbegin() const {
+            return begin();
+        }
+
+        const_iterator cend() const {
+            return end();
+        }
+
+        reverse_iterator rbegin() {
+            return reverse_iterator(end());
+        }
+
+        const_reverse_iterator rbegin() const {
+            return const_reverse_iterator(end());
+        }
+
+        reverse_iterator rend() {
+            return reverse_iterator(begin());
+        }
+
+        const_reverse_iterator rend() const {
+            return const_reverse_iterator(begin());
+        }
+
+        const_reverse_iterator crbegin() const {
+            return rbegin();
+        }
+
+        const_reverse_iterator crend() const {
+            return rend();
+        }
+
+        bool empty() const {
+            return listSize == 0;
+        }
+
+        size_t size() const {
+            return listSize;
+        }
+
+        size_t max_size() const {
+            return std::min<size_t>(chunk_allocator_traits::max_size(chunkAllocator) * N,
+                                    std::numeric_limits<difference_type>::max());
+        }
+
+        void clear() {
+            while (sentinel.next != &sentinel) {
+                Chunk* buffer = chunk(sentinel.next);
+                for (size_type i(0); i < buffer->count; ++i) {
+                    chunk_allocator_traits::destroy(chunkAllocator, &buffer->at(i));
+                }
+                destroyChunk(buffer);
+            }
+            listSize = 0;
+        }
+
+        iterator insert(const_iterator pos, const value_type& value) {
+            return emplace(pos, value);
+        }
+
+        iterator insert(const_iterator pos, value_type&& value) {
+            return emplace(pos, std::move(value));
+        }
+
+        iterator insert(const_iterator pos, size_type count, const T& value) {
+            if (count == 0) {
+                return iterator(pos.owner, pos.index);
+            }
+            iterator result = emplace(pos, value);
+            iterator it = result;
+            for (size_type i(1); i < count; ++i) {
+                it = emplace(std::next(it), value);
+            }
+            // The later insertions may have split the chunk of the first element.
+            return std::prev(it, count - 1);
+        }
+
+        template<class... Args>
+        iterator emplace(const_iterator pos, Args&& ... args) {
+            auto [target, index] = placeBefore(pos.owner, pos.index);
+            if (target->count < N) {
+                return constructAt(target, index, std::forward<Args>(args)...);
+            }
+            // The arguments may refer to an element that the split moves, so the new value is
+            // built before it. The head then has room for it at its end.
+            T value(std::forward<Args>(args)...);
+            Chunk* head = split(target, index).first;
+            return constructAt(head, head->count, std::move(value));
+        }
+
+        iterator erase(const_iterator pos) {
+            Chunk* buffer = chunk(pos.owner);
+            eraseAt(buffer, pos.index);
+            if (buffer->count == 0) {
+                ChunkBase* next = buffer->next;
+                destroyChunk(buffer);
+                return iterator(next, 0);
+            }
+            return position(buffer, pos.index);
+        }
+
+        iterator erase(const_iterator first, const_iterator last) {
+            // Erasing shifts the positions after it, so last is only good for counting.
+            difference_type count = std::distance(first, last);
+            iterator it(first.owner, first.index);
+            for (; count > 0; --count) {
+                it = erase(it);
+            }
+            return it;
+        }
+
+        void push_back(const T& value) {
+            emplace_back(value);
+        }
+
+        void push_back(T&& value) {
+            emplace_back(std::move(value));
+        }
+
+        void pop_back() {
+            erase(std::prev(cend()));
+        }
+
+        void push_front(const T& value) {
+            emplace_front(value);
+        }
+
+        void push_front(T&& value) {
+            emplace_front(std::move(value));
+        }
+
+        void pop_front() {
+            erase(cbegin());
+        }
+
+        template<class... Args>
+        T& emplace_back(Args&& ... args) {
+            return *emplace(cend(), std::forward<Args>(args)...);
+        }
+
+        template<class... Args>
+        T& emplace_front(Args&& ... args) {
+            return *emplace(cbegin(), std::forward<Args>(args)...);
+        }
+
+        void resize(size_type count) {
+            while (listSize > count) {
+                pop_back();
+            }
+            while (listSize < count) {
+                emplace_back();
+            }
+        }
+
+        void swap(unrolled_list& other) {
+            if (this == &other) {
+                return;
+            }
+            std::swap(chunkAllocator, other.chunkAllocator);
+            std::swap(sentinel, other.sentinel);
+            std::swap(listSize, other.listSize);
+            adoptChunks();
+            other.adoptChunks();
+        }
+
+        // Moves the chunks of other before pos. O(1) when pos starts a chunk (begin() and end()
+        // always do); otherwise the chunk of pos is split there first.
+        void splice(const_iterator pos, unrolled_list& other) {
+            if (this == &other || other.listSize == 0) {
+                return;
+            }
+            ChunkBase* before = pos.owner;
+            if (pos.index != 0) {
+                before = split(chunk(pos.owner), pos.index).second;
+            }
+            linkBefore(before, other.sentinel.next, other.sentinel.prev);
+            listSize += other.listSize;
+            other.reset();
+        }
+
+        // Moves the element at it from other before pos. Within one chunk only the order
+        // changes, and a chunk holding nothing else is relinked when pos starts a chunk.
+        // Otherwise the element is moved into this list like an insert followed by an erase,
+        // which invalidates references to it: it lives inside its chunk, so it cannot leave
+        // the chunk without moving.
+        void splice(const_iterator pos, unrolled_list& other, const_iterator it) {
+            Chunk* source = chunk(it.owner);
+            if (pos.owner == it.owner) {
+                index_type* order = source->order;
+                if (pos.index > it.index) {
+                    std::rotate(order + it.index, order + it.index + 1, order + pos.index);
+                } else {
+                    std::rotate(order + pos.index, order + it.index, order + it.index + 1);
+                }
+                return;
+            }
+            if (source->count == 1 && pos.index == 0) {
+                if (pos.owner != source->next) {
+                    source->prev->next = source->next;
+                    source->next->prev = source->prev;
+                    linkBefore(pos.owner, source, source);
+                }
+                --other.listSize;
+                ++listSize;
+                return;
+            }
+            T value(std::move(*iterator(it.owner, it.index)));
+            // pos is in another chunk, so erasing leaves it valid even when source goes away.
+            other.eraseAt(source, it.index);
+            if (source->count == 0) {
+                other.destroyChunk(source);
+            }
+            emplace(pos, std::move(value));
+        }
+
+        void remove(const T& value) {
+            // value may be one of the elements: erasing moves nothing, and that element is
+            // erased after the others, so its chunk is never empty before then.
+            Chunk* deferred = nullptr;
+            for (ChunkBase* buffer = sentinel.next; buffer != &sentinel;) {
+                for (size_type i(0); i < buffer->count;) {
+                    T& element = chunk(buffer)->at(i);
+                    if (&element == &value) {
+                        deferred = chunk(buffer);
+                        ++i;
+                    } else if (element == value) {
+                        eraseAt(chunk(buffer), i);
+                    } else {
+                        ++i;
+                    }
+                }
+                ChunkBase* next = buffer->next;
+                if (buffer->count == 0) {
+                    destroyChunk(chunk(buffer));
+                }
+                buffer = next;
+            }
+            if (deferred) {
+                size_type i(0);
+                while (&deferred->at(i) != &value) {
+                    ++i;
+                }
+                eraseAt(deferred, i);
+                if (deferred->count == 0) {
+                    destroyChunk(deferred);
+                }
+            }
+        }
+
+        // Packs the elements into as few chunks as possible, every chunk but the last full.
+        // Like std::deque::shrink_to_fit, it invalidates all iterators and references.
+        void shrink_to_fit() {
+            ChunkBase* buffer = sentinel.next;
+            while (buffer != &sentinel && buffer->next != &sentinel) {
+                Chunk* next = chunk(buffer->next);
+                const size_type count = std::min(N - buffer->count, next->count);
+                transferElements(next, 0, count, chunk(buffer), buffer->count);
+                if (next->count == 0) {
+                    destroyChunk(next);
+                } else {
+                    buffer = next;
+                }
+            }
+        }
+
+        // Reverses the chunk ring and the order of every chunk; no element moves.
+        void reverse() {
+            ChunkBase* buffer = &sentinel;
+            do {
+                std::swap(buffer->next, buffer->prev);
+                buffer = buffer->prev;
+                if (buffer != &sentinel) {
+                    std::reverse(chunk(buffer)->order, chunk(buffer)->order + buffer->count);
+                }
+            } while (buffer != &sentinel);
+        }
+
+        void unique() {
+            if (listSize < 2) {
+                return;
+            }
+            iterator previous = begin();
+            iterator it = std::next(previous);
+            while (it != end()) {
+                if (*it == *previous) {
+                    it = erase(it);
+                    previous = std::prev(it);
+                } else {
+                    previous = it++;
+                }
+            }
+        }
+
+    };
+
+}  // namespace task
@@ -5,6 +5,7 @@
 #include <vector>
 #include <list>
 #include "src/list.h"
+#include "src/unrolled_list.h"
 
 
 size_t RandomUInt(size_t max = -1) {
@@ -62,6 +63,43 @@ struct ArgForwardTester {
 };
 
 
+// Counts the calls to allocate and the elements requested, shared by all rebound copies.
+struct AllocationStats {
+    size_t calls = 0;
+    size_t elements = 0;
+    size_t live = 0;
+};
+
+template <class T>
+struct CountingAllocator {
+    using value_type = T;
+
+    AllocationStats* stats;
+
+    explicit CountingAllocator(AllocationStats* stats) : stats(stats) {}
+
+    template <class U>
+    CountingAllocator(const CountingAllocator<U>& other) : stats(other.stats) {}
+
+    T* allocate(size_t count) {
+        ++stats->calls;
+        stats->elements += count;
+        ++stats->live;
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T* pointer, size_t count) {
+        --stats->live;
+        std::allocator<T>().deallocate(pointer, count);
+    }
+
+    template <class U>
+    bool operator==(const CountingAllocator<U>& other) const { return stats == other.stats; }
+    template <class U>
+    bool operator!=(const CountingAllocator<U>& other) const { return stats != other.stats; }
+};
+
+
 void FailWithMsg(const std::string& msg, int line) {
     std::cerr << "Test failed!\n";
     std::cerr << "[Line " << line << "] "  << msg << std::endl;
@@ -131,14 +169,14 @@ int main() {
         ASSERT_TRUE_MSG(list.back().action == "MC", "rvalue push_front")
         ASSERT_TRUE_MSG(std::next(list.cbegin())->action == "MC", "rvalue insert")
 
-        /*task::list<ArgForwardTester> list2;
+        task::list<ArgForwardTester> list2;
         MoveTester mt;    // reusable after move because object is left valid
         list2.emplace_back(MoveTester(), mt, std::move(mt));
         list2.emplace_front(mt, std::move(mt), MoveTester());
         list2.emplace(std::next(list2.begin()), std::move(mt), MoveTester(), mt);
         ASSERT_TRUE_MSG(list2.back().actions == "MCCCMC", "emplace_back")
         ASSERT_TRUE_MSG(list2.front().actions == "CCMCMC", "emplace_front")
-        ASSERT_TRUE_MSG(std::next(list2.begin())->actions == "MCMCCC", "emplace")*/
+        ASSERT_TRUE_MSG(std::next(list2.begin())->actions == "MCMCCC", "emplace")
     }
 
 
@@ -163,7 +201,147 @@ int main() {
 
         ASSERT_EQUAL_MSG(list_task, list_std, "list::erase")
     }
-/*
+
+    {
+        task::list<size_t> list_task;
+        std::list<size_t> list_std;
+        RandomFill(list_std, RandomUInt(100000, 200000), 1000);
+        for (size_t value : list_std) {
+            list_task.push_back(value);
+        }
+        list_task.sort();
+        list_std.sort();
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::sort")
+
+        list_task.sort(std::greater<size_t>());
+        list_std.sort(std::greater<size_t>());
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::sort with comparator")
+
+        list_task.front() = 1001;
+        const size_t* greatest_node = &list_task.front();
+        list_task.sort();
+        ASSERT_TRUE_MSG(&list_task.back() == greatest_node, "list::sort keeps nodes")
+
+        task::list<std::pair<size_t, size_t>> pairs_task;
+        std::list<std::pair<size_t, size_t>> pairs_std;
+        for (size_t i = 0; i < 10000; ++i) {
+            pairs_task.push_back({RandomUInt(20), i});
+            pairs_std.push_back(pairs_task.back());
+        }
+        auto by_key = [](const auto& left, const auto& right) { return left.first < right.first; };
+        pairs_task.sort(by_key);
+        pairs_std.sort(by_key);
+        ASSERT_EQUAL_MSG(pairs_task, pairs_std, "list::sort stability")
+        ASSERT_TRUE_MSG(std::prev(pairs_task.end())->second == pairs_std.back().second, "list::sort stability")
+    }
+
+    {
+        AllocationStats stats;
+        {
+            task::list<size_t, CountingAllocator<size_t>> list{CountingAllocator<size_t>(&stats)};
+            for (size_t i = 0; i < 1000; ++i) {
+                list.push_back(i);
+            }
+            ASSERT_TRUE_MSG(stats.elements < 2000 && stats.calls < 20, "Nodes come from slabs")
+
+            const size_t calls = stats.calls;
+            for (size_t round = 0; round < 100; ++round) {
+                for (size_t i = 0; i < 500; ++i) {
+                    list.pop_front();
+                }
+                for (size_t i = 0; i < 500; ++i) {
+                    list.insert(std::next(list.begin(), i % 7), i);
+                }
+            }
+            list.clear();
+            list.resize(1000);
+            ASSERT_TRUE_MSG(stats.calls == calls && list.size() == 1000, "Erased nodes are reused")
+
+            task::list<size_t, CountingAllocator<size_t>> list2{CountingAllocator<size_t>(&stats)};
+            list2.push_back(1);
+            list2.push_back(2);
+            auto& element_reference = list2.back();
+            list.splice(list.begin(), list2);
+            list.splice(list.begin(), list, std::prev(list.end()));
+            list2 = std::move(list);
+            element_reference = 42;
+            ASSERT_TRUE_MSG(list2.size() == 1002 && *std::next(list2.begin(), 2) == 42, "Spliced nodes outlive their list")
+
+            // Nodes handed over one at a time keep their address, and the producer reuses
+            // the slots that the consumer frees instead of allocating new slabs.
+            task::list<size_t, CountingAllocator<size_t>> producer{CountingAllocator<size_t>(&stats)};
+            for (size_t i = 0; i < 100; ++i) {
+                producer.push_back(i);
+            }
+            const size_t* moved_node = &producer.back();
+            list2.splice(list2.begin(), producer, std::prev(producer.end()));
+            ASSERT_TRUE_MSG(&list2.front() == moved_node && list2.size() == 1003 && producer.size() == 99,
+                            "list::splice of one element relinks its node")
+            const size_t producer_calls = stats.calls;
+            for (size_t round = 0; round < 10000; ++round) {
+                producer.push_back(round);
+                list2.splice(list2.end(), producer, producer.begin());
+                list2.pop_back();
+            }
+            ASSERT_TRUE_MSG(stats.calls == producer_calls && producer.size() == 99, "Spliced nodes return to a shared free list")
+        }
+        ASSERT_TRUE_MSG(stats.live == 0, "Slabs are released")
+    }
+
+    {
+        task::list<Immovable> list, list2(3);
+        list.emplace_back();
+        const Immovable* moved_node = &list.back();
+        list2.splice(std::next(list2.begin()), list, list.begin());
+        ASSERT_TRUE_MSG(list.empty() && list2.size() == 4 && &*std::next(list2.begin()) == moved_node,
+                        "list::splice of an immovable element")
+    }
+
+    {
+        task::list<size_t> list_task, list_task2;
+        std::list<size_t> list_std, list_std2;
+        RandomFill(list_std, RandomUInt(1000, 5000), 100);
+        RandomFill(list_std2, RandomUInt(1000, 5000), 100);
+        list_std.sort();
+        list_std2.sort();
+        for (size_t value : list_std) {
+            list_task.push_back(value);
+        }
+        for (size_t value : list_std2) {
+            list_task2.push_back(value);
+        }
+
+        auto& element_reference = list_task2.front();
+        list_task.merge(list_task2);
+        list_std.merge(list_std2);
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::merge")
+        ASSERT_TRUE_MSG(list_task2.empty() && list_task.size() == list_std.size(), "list::merge")
+        const size_t element_value = element_reference;
+        element_reference = 1000;
+        ASSERT_TRUE_MSG(std::find(list_task.begin(), list_task.end(), 1000) != list_task.end(), "list::merge")
+        element_reference = element_value;
+
+        list_task.reverse();
+        list_std.reverse();
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::reverse")
+        ASSERT_TRUE_MSG(list_task.back() == list_std.back(), "list::reverse")
+
+        task::list<size_t> list_task3;
+        std::list<size_t> list_std3;
+        RandomFill(list_std3, RandomUInt(1, 100), 2000);
+        list_std3.sort(std::greater<size_t>());
+        for (size_t value : list_std3) {
+            list_task3.push_back(value);
+        }
+        list_task.merge(list_task3, std::greater<size_t>());
+        list_std.merge(list_std3, std::greater<size_t>());
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::merge with comparator")
+
+        task::list<size_t> list_task4;
+        list_task4.merge(list_task);
+        ASSERT_TRUE_MSG(list_task4.size() == list_std.size() && list_task.empty(), "list::merge into empty list")
+        ASSERT_EQUAL_MSG(list_task4, list_std, "list::merge into empty list")
+    }
 
     {
         task::list<size_t> list;
@@ -330,5 +508,209 @@ int main() {
             }
         }
     }
-*/
+
+    {
+        // unrolled_list against std::list under random inserts, erases and splices
+        // at arbitrary positions, with a small N so that chunks split often.
+        task::unrolled_list<size_t, 4> unrolled;
+        std::list<size_t> reference;
+
+        for (size_t iter = 0; iter < 20000; ++iter) {
+            const size_t at = RandomUInt(reference.size());
+            auto it_unrolled = std::next(unrolled.begin(), at);
+            auto it_std = std::next(reference.begin(), at);
+            switch (RandomUInt(6)) {
+                case 0:
+                case 1: {
+                    auto val = RandomUInt(20);
+                    ASSERT_TRUE(*unrolled.insert(it_unrolled, val) == *reference.insert(it_std, val));
+                    break;
+                }
+                case 2:
+                    if (it_std != reference.end()) {
+                        auto next_unrolled = unrolled.erase(it_unrolled);
+                        auto next_std = reference.erase(it_std);
+                        ASSERT_TRUE(std::distance(unrolled.begin(), next_unrolled) == std::distance(reference.begin(), next_std));
+                    }
+                    break;
+                case 3: {
+                    task::unrolled_list<size_t, 4> other_unrolled;
+                    std::list<size_t> other_std;
+                    RandomFill(other_unrolled, RandomUInt(9), 20);
+                    other_std.assign(other_unrolled.begin(), other_unrolled.end());
+                    unrolled.splice(it_unrolled, other_unrolled);
+                    reference.splice(it_std, other_std);
+                    ASSERT_TRUE(other_unrolled.empty());
+                    break;
+                }
+                case 4: {
+                    const size_t count = RandomUInt(3);
+                    auto val = RandomUInt(20);
+                    unrolled.insert(it_unrolled, count, val);
+                    reference.insert(it_std, count, val);
+                    break;
+                }
+                case 6:
+                    if (!reference.empty()) {
+                        const size_t from = RandomUInt(reference.size() - 1);
+                        unrolled.splice(it_unrolled, unrolled, std::next(unrolled.begin(), from));
+                        reference.splice(it_std, reference, std::next(reference.begin(), from));
+                    } else {
+                        task::unrolled_list<size_t, 4> other_unrolled(3, RandomUInt(20));
+                        std::list<size_t> other_std(other_unrolled.begin(), other_unrolled.end());
+                        unrolled.splice(unrolled.end(), other_unrolled, std::next(other_unrolled.begin()));
+                        reference.splice(reference.end(), other_std, std::next(other_std.begin()));
+                        ASSERT_EQUAL_MSG(other_unrolled, other_std, "unrolled_list: splice one element")
+                    }
+                    break;
+                case 5:
+                    switch (RandomUInt(4)) {
+                        case 0:
+                            unrolled.reverse();
+                            reference.reverse();
+                            break;
+                        case 1:
+                            unrolled.unique();
+                            reference.unique();
+                            break;
+                        case 2:
+                            if (!reference.empty()) {
+                                unrolled.remove(unrolled.front());
+                                reference.remove(reference.front());
+                            }
+                            break;
+                        case 3:
+                            if (reference.size() > 200) {
+                                unrolled.erase(std::next(unrolled.begin(), 50), std::prev(unrolled.end(), 50));
+                                reference.erase(std::next(reference.begin(), 50), std::prev(reference.end(), 50));
+                            }
+                            break;
+                        case 4:
+                            unrolled.shrink_to_fit();
+                            break;
+                    }
+                    break;
+            }
+            ASSERT_TRUE(unrolled.size() == reference.size());
+            ASSERT_EQUAL_MSG(unrolled, reference, "unrolled_list: random edit")
+        }
+        ASSERT_TRUE(std::equal(unrolled.rbegin(), unrolled.rend(), reference.rbegin(), reference.rend()));
+
+        const auto copy = unrolled;
+        ASSERT_EQUAL_MSG(copy, reference, "unrolled_list: copy")
+        auto moved = std::move(unrolled);
+        ASSERT_TRUE(unrolled.empty());
+        ASSERT_EQUAL_MSG(moved, reference, "unrolled_list: move")
+        moved.swap(unrolled);
+        ASSERT_TRUE(moved.empty());
+        ASSERT_EQUAL_MSG(unrolled, reference, "unrolled_list: swap")
+    }
+
+    {
+        // Inserting into a full chunk a value taken from the half that the split moves.
+        task::unrolled_list<std::string, 4> unrolled;
+        for (char c : std::string("abcd")) {
+            unrolled.push_back(std::string(40, c));
+        }
+        unrolled.insert(std::next(unrolled.begin()), unrolled.back());
+        unrolled.emplace(std::next(unrolled.begin(), 4), *std::next(unrolled.begin(), 3));
+        const std::list<std::string> expected{std::string(40, 'a'), std::string(40, 'd'), std::string(40, 'b'),
+                                              std::string(40, 'c'), std::string(40, 'c'), std::string(40, 'd')};
+        ASSERT_EQUAL_MSG(unrolled, expected, "unrolled_list: insert a value from a split chunk")
+    }
+
+    {
+        // Appending, prepending, inserting into chunks with room and reversing never move
+        // elements of an unrolled_list.
+        task::unrolled_list<std::string, 8> unrolled;
+        std::vector<const std::string*> addresses;
+        for (size_t i = 0; i < 96; ++i) {
+            addresses.push_back(&unrolled.emplace_back(std::to_string(i)));
+        }
+        unrolled.pop_back();
+        unrolled.insert(std::prev(unrolled.end(), 3), "inserted");
+        for (size_t i = 0; i < 50; ++i) {
+            unrolled.emplace_front("front");
+            unrolled.emplace_back("back");
+        }
+        unrolled.reverse();
+        for (size_t i = 0; i < 95; ++i) {
+            ASSERT_TRUE_MSG(*addresses[i] == std::to_string(i), "unrolled_list: stable references");
+        }
+        ASSERT_TRUE(unrolled.size() == 196);
+        ASSERT_TRUE(unrolled.front() == "back" && unrolled.back() == "front");
+    }
+
+    {
+        // Erasing and removing never move the remaining elements; shrink_to_fit packs the
+        // sparse chunks they leave behind.
+        AllocationStats stats;
+        task::unrolled_list<int, 32, CountingAllocator<int>> unrolled{CountingAllocator<int>(&stats)};
+        for (int i = 0; i < 3200; ++i) {
+            unrolled.push_back(i);
+        }
+        std::vector<const int*> addresses;
+        for (auto it = unrolled.begin(); it != unrolled.end();) {
+            if (*it % 32 == 0) {
+                addresses.push_back(&*it++);
+            } else {
+                it = unrolled.erase(it);
+            }
+        }
+        ASSERT_TRUE(unrolled.size() == 100 && stats.live == 100);
+        std::vector<int> expected;
+        for (int i = 0; i < 3200; i += 32) {
+            expected.push_back(i);
+        }
+        ASSERT_EQUAL_MSG(unrolled, expected, "unrolled_list: erase")
+        for (size_t i = 0; i < addresses.size(); ++i) {
+            ASSERT_TRUE_MSG(*addresses[i] == expected[i], "unrolled_list: stable references after erase");
+        }
+        unrolled.shrink_to_fit();
+        ASSERT_TRUE_MSG(stats.live == 4, "unrolled_list: shrink_to_fit packs chunks")
+        ASSERT_EQUAL_MSG(unrolled, expected, "unrolled_list: shrink_to_fit")
+
+        for (int i = 0; i < 3200; ++i) {
+            unrolled.push_back(i % 7);
+        }
+        const int* kept = &*std::prev(unrolled.end(), 2);
+        unrolled.remove(3);
+        unrolled.remove(unrolled.back());
+        ASSERT_TRUE_MSG(*kept == 3198 % 7, "unrolled_list: stable references after remove");
+        unrolled.shrink_to_fit();
+        ASSERT_TRUE_MSG(stats.live == (unrolled.size() + 31) / 32, "unrolled_list: shrink_to_fit after remove")
+    }
+
+    {
+        // Splicing an element that is alone in its chunk relinks the chunk.
+        task::unrolled_list<std::string, 4> unrolled(4, "a");
+        task::unrolled_list<std::string, 4> other(4, "b");
+        other.push_back("c");
+        const std::string* spliced = &other.back();
+        unrolled.splice(unrolled.begin(), other, std::prev(other.end()));
+        ASSERT_TRUE_MSG(&unrolled.front() == spliced && *spliced == "c", "unrolled_list: splice relinks a chunk")
+        ASSERT_TRUE(unrolled.size() == 5 && other.size() == 4);
+    }
+
+    {
+        // One allocation per chunk: full chunks cost N elements per allocation.
+        AllocationStats stats;
+        {
+            task::unrolled_list<int, 16, CountingAllocator<int>> unrolled{CountingAllocator<int>(&stats)};
+            for (int i = 0; i < 1600; ++i) {
+                unrolled.push_back(i);
+            }
+            ASSERT_TRUE(stats.calls == 100);
+            unrolled.insert(std::next(unrolled.begin(), 5), -1);
+            ASSERT_TRUE(stats.calls == 101);
+        }
+        ASSERT_TRUE(stats.live == 0);
+    }
+
+    {
+        task::unrolled_list<ArgForwardTester> forwarded;
+        MoveTester tester;
+        forwarded.emplace_back(tester, MoveTester(), std::move(tester));
+        ASSERT_TRUE(forwarded.back().actions == "CCMCMC");
+    }
 }
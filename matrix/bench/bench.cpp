@@ -0,0 +1,475 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "src/matrix.h"
+#include "src/batch.h"
+#include "src/matrix_io.h"
+#include "src/simd.h"
+#include "src/thread_pool.h"
+
+
+// A small stand-in for Google Benchmark: the same registration and `for ([[maybe_unused]] auto _ : state)` loop,
+// and the same JSON layout, so its tooling (and bench/compare.py) can read the results.
+
+using task::Matrix;
+using Clock = std::chrono::steady_clock;
+
+
+template<class T>
+void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+
+class State {
+private:
+    size_t iterations;
+    size_t size;
+    Clock::time_point startReal, stopReal;
+    std::clock_t startCpu, stopCpu;
+    Clock::duration pausedReal;
+    std::clock_t pausedCpu;
+    Clock::time_point pauseReal;
+    std::clock_t pauseCpu;
+
+public:
+    State(size_t iterations, size_t size)
+        : iterations(iterations), size(size), startCpu(0), stopCpu(0), pausedReal(0), pausedCpu(0) {}
+
+    // Timing stops as the last iteration finishes, when the iterator reaches end().
+    struct Iterator {
+        State* state;
+        size_t left;
+
+        bool operator!=(const Iterator& other) const { return left != other.left; }
+
+        void operator++() {
+            if (--left == 0)
+                state->stop();
+        }
+
+        int operator*() const { return 0; }
+    };
+
+    Iterator begin() {
+        startReal = Clock::now();
+        startCpu = std::clock();
+        if (iterations == 0)
+            stop();
+        return {this, iterations};
+    }
+
+    Iterator end() { return {this, 0}; }
+
+    void stop() {
+        stopReal = Clock::now();
+        stopCpu = std::clock();
+    }
+
+    // Excludes per-iteration setup from the measurement.
+    void PauseTiming() {
+        pauseReal = Clock::now();
+        pauseCpu = std::clock();
+    }
+
+    void ResumeTiming() {
+        pausedReal += Clock::now() - pauseReal;
+        pausedCpu += std::clock() - pauseCpu;
+    }
+
+    size_t range() const { return size; }
+    size_t getIterations() const { return iterations; }
+
+    double realSeconds() const {
+        return std::chrono::duration<double>(stopReal - startReal - pausedReal).count();
+    }
+
+    double cpuSeconds() const {
+        return static_cast<double>(stopCpu - startCpu - pausedCpu) / CLOCKS_PER_SEC;
+    }
+};
+
+
+struct Benchmark {
+    std::string name;
+    std::function<void(State&)> body;
+    std::vector<size_t> sizes;
+};
+
+std::vector<Benchmark>& Registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+std::vector<size_t> Sizes(size_t from, size_t to) {
+    std::vector<size_t> sizes;
+    for (size_t size = from; size <= to; size *= 4)
+        sizes.push_back(size);
+    return sizes;
+}
+
+int Register(const std::string& name, std::function<void(State&)> body, std::vector<size_t> sizes) {
+    Registry().push_back({name, body, sizes});
+    return 0;
+}
+
+#define BENCHMARK(function, from, to) \
+    static int function##_registered = Register(#function, function, Sizes(from, to));
+
+
+double RandomDouble() {
+    static std::mt19937 rand(42);
+
+    std::uniform_real_distribution<double> dist{-10., 10.};
+    return dist(rand);
+}
+
+Matrix RandomMatrix(size_t rows, size_t cols) {
+    Matrix temp(rows, cols);
+    for (size_t row = 0; row < rows; ++row) {
+        for (size_t col = 0; col < cols; ++col) {
+            temp[row][col] = RandomDouble();
+        }
+    }
+    return temp;
+}
+
+
+void BM_Construct(State& state) {
+    const size_t n = state.range();
+    for ([[maybe_unused]] auto _ : state) {
+        Matrix mat(n, n);
+        DoNotOptimize(mat);
+    }
+}
+BENCHMARK(BM_Construct, 4, 4096)
+
+void BM_Copy(State& state) {
+    const size_t n = state.range();
+    auto source = RandomMatrix(n, n);
+    for ([[maybe_unused]] auto _ : state) {
+        Matrix copy(source);
+        DoNotOptimize(copy);
+    }
+}
+BENCHMARK(BM_Copy, 4, 4096)
+
+void BM_Add(State& state) {
+    const size_t n = state.range();
+    auto mat1 = RandomMatrix(n, n), mat2 = RandomMatrix(n, n);
+    for ([[maybe_unused]] auto _ : state) {
+        auto sum = mat1 + mat2;
+        DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_Add, 4, 4096)
+
+// Same as BM_Add with temporaries recycled through a MatrixPool.
+void BM_AddPooled(State& state) {
+    const size_t n = state.range();
+    auto mat1 = RandomMatrix(n, n), mat2 = RandomMatrix(n, n);
+    task::MatrixPool pool;
+    task::setDefaultMatrixResource(&pool);
+    for ([[maybe_unused]] auto _ : state) {
+        auto sum = mat1 + mat2;
+        DoNotOptimize(sum);
+    }
+    task::setDefaultMatrixResource(nullptr);
+}
+BENCHMARK(BM_AddPooled, 4, 4096)
+
+void BM_MultiplySquare(State& state) {
+    const size_t n = state.range();
+    auto mat1 = RandomMatrix(n, n), mat2 = RandomMatrix(n, n);
+    for ([[maybe_unused]] auto _ : state) {
+        auto product = mat1 * mat2;
+        DoNotOptimize(product);
+    }
+}
+BENCHMARK(BM_MultiplySquare, 4, 4096)
+
+// (n x n/4) * (n/4 x 2n): a thin inner dimension, as in rank-k updates.
+void BM_MultiplyRectangular(State& state) {
+    const size_t n = state.range();
+    auto mat1 = RandomMatrix(n, n / 4), mat2 = RandomMatrix(n / 4, 2 * n);
+    for ([[maybe_unused]] auto _ : state) {
+        auto product = mat1 * mat2;
+        DoNotOptimize(product);
+    }
+}
+BENCHMARK(BM_MultiplyRectangular, 4, 4096)
+
+void BM_Det(State& state) {
+    const size_t n = state.range();
+    auto mat = RandomMatrix(n, n);
+    for ([[maybe_unused]] auto _ : state) {
+        auto det = mat.det();
+        DoNotOptimize(det);
+    }
+}
+BENCHMARK(BM_Det, 4, 4096)
+
+void BM_Transpose(State& state) {
+    const size_t n = state.range();
+    auto mat = RandomMatrix(n, n);
+    for ([[maybe_unused]] auto _ : state) {
+        mat.transpose();
+        DoNotOptimize(mat);
+    }
+}
+BENCHMARK(BM_Transpose, 4, 4096)
+
+void BM_TransposedRectangular(State& state) {
+    const size_t n = state.range();
+    auto mat = RandomMatrix(n, 2 * n);
+    for ([[maybe_unused]] auto _ : state) {
+        auto transposed = mat.transposed();
+        DoNotOptimize(transposed);
+    }
+}
+BENCHMARK(BM_TransposedRectangular, 4, 4096)
+
+// Text I/O of a 4096 x 4096 matrix needs a few hundred megabytes of text, so it stops at 1024.
+void BM_StreamWrite(State& state) {
+    const size_t n = state.range();
+    auto mat = RandomMatrix(n, n);
+    for ([[maybe_unused]] auto _ : state) {
+        std::stringstream stream;
+        stream << mat;
+        DoNotOptimize(stream);
+    }
+}
+BENCHMARK(BM_StreamWrite, 4, 1024)
+
+void BM_StreamRead(State& state) {
+    const size_t n = state.range();
+    std::stringstream source;
+    source.precision(17);
+    source << n << ' ' << n << '\n' << RandomMatrix(n, n);
+    const std::string text = source.str();
+    Matrix mat;
+    for ([[maybe_unused]] auto _ : state) {
+        state.PauseTiming();
+        std::stringstream stream(text);
+        state.ResumeTiming();
+        stream >> mat;
+        DoNotOptimize(mat);
+    }
+}
+BENCHMARK(BM_StreamRead, 4, 1024)
+
+void BM_TextWrite(State& state) {
+    const size_t n = state.range();
+    auto mat = RandomMatrix(n, n);
+    for ([[maybe_unused]] auto _ : state) {
+        std::stringstream stream;
+        task::writeText(stream, mat);
+        DoNotOptimize(stream);
+    }
+}
+BENCHMARK(BM_TextWrite, 4, 1024)
+
+void BM_TextParse(State& state) {
+    const size_t n = state.range();
+    std::stringstream source;
+    task::writeText(source, RandomMatrix(n, n));
+    const std::string text = source.str();
+    for ([[maybe_unused]] auto _ : state) {
+        auto mat = task::parseText(text);
+        DoNotOptimize(mat);
+    }
+}
+BENCHMARK(BM_TextParse, 4, 1024)
+
+// BATCH_COUNT independent n x n products or determinants, once as separate Matrix objects and
+// once through a MatrixBatch.
+const size_t BATCH_COUNT = 4096;
+
+task::MatrixBatch RandomBatch(size_t n) {
+    task::MatrixBatch batch(BATCH_COUNT, n, n);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            for (size_t index = 0; index < BATCH_COUNT; ++index)
+                batch.getLane(i, j)[index] = RandomDouble();
+    return batch;
+}
+
+void BM_SmallMultiply(State& state) {
+    const size_t n = state.range();
+    std::vector<Matrix> left, right;
+    for (size_t index = 0; index < BATCH_COUNT; ++index) {
+        left.push_back(RandomMatrix(n, n));
+        right.push_back(RandomMatrix(n, n));
+    }
+    for ([[maybe_unused]] auto _ : state)
+        for (size_t index = 0; index < BATCH_COUNT; ++index) {
+            auto product = left[index] * right[index];
+            DoNotOptimize(product);
+        }
+}
+BENCHMARK(BM_SmallMultiply, 4, 16)
+
+void BM_BatchedMultiply(State& state) {
+    const size_t n = state.range();
+    auto left = RandomBatch(n), right = RandomBatch(n);
+    for ([[maybe_unused]] auto _ : state) {
+        auto product = task::batchedMultiply(left, right);
+        DoNotOptimize(product);
+    }
+}
+BENCHMARK(BM_BatchedMultiply, 4, 16)
+
+void BM_SmallDet(State& state) {
+    const size_t n = state.range();
+    std::vector<Matrix> matrices;
+    for (size_t index = 0; index < BATCH_COUNT; ++index)
+        matrices.push_back(RandomMatrix(n, n));
+    for ([[maybe_unused]] auto _ : state)
+        for (const Matrix& matrix : matrices) {
+            auto det = matrix.det();
+            DoNotOptimize(det);
+        }
+}
+BENCHMARK(BM_SmallDet, 4, 16)
+
+void BM_BatchedDet(State& state) {
+    const size_t n = state.range();
+    auto batch = RandomBatch(n);
+    for ([[maybe_unused]] auto _ : state) {
+        auto dets = task::batchedDet(batch);
+        DoNotOptimize(dets);
+    }
+}
+BENCHMARK(BM_BatchedDet, 4, 16)
+
+// Alternates between growing to (n + 1) x (n + 1) and shrinking back to n x n.
+void BM_Resize(State& state) {
+    const size_t n = state.range();
+    auto mat = RandomMatrix(n, n);
+    bool grow = true;
+    for ([[maybe_unused]] auto _ : state) {
+        mat.resize(grow ? n + 1 : n, grow ? n + 1 : n);
+        grow = !grow;
+        DoNotOptimize(mat);
+    }
+}
+BENCHMARK(BM_Resize, 4, 4096)
+
+
+struct Result {
+    std::string name;
+    size_t iterations;
+    double realTime, cpuTime;
+};
+
+// Grows the iteration count until one run takes at least minTime seconds.
+Result Run(const Benchmark& benchmark, size_t size, double minTime) {
+    size_t iterations = 1;
+    while (true) {
+        State state(iterations, size);
+        benchmark.body(state);
+        const double seconds = state.realSeconds();
+        if (seconds >= minTime || iterations >= (size_t(1) << 30)) {
+            return {benchmark.name + "/" + std::to_string(size), iterations,
+                    seconds * 1e9 / iterations, state.cpuSeconds() * 1e9 / iterations};
+        }
+        const double factor = seconds > 0 ? std::min(10., 1.4 * minTime / seconds) : 10.;
+        iterations = std::max(iterations + 1, static_cast<size_t>(iterations * factor));
+    }
+}
+
+std::string Quoted(const std::string& text) {
+    std::string result = "\"";
+    for (char symbol : text) {
+        if (symbol == '"' || symbol == '\\')
+            result += '\\';
+        result += symbol;
+    }
+    return result + "\"";
+}
+
+void WriteJson(std::ostream& out, const std::vector<Result>& results) {
+    char date[64];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    out << "{\n  \"context\": {\n";
+    out << "    \"date\": " << Quoted(date) << ",\n";
+    out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "    \"threads\": " << task::parallel::getThreadsCount() << ",\n";
+    out << "    \"instruction_set\": " << Quoted(task::simd::instructionSet()) << ",\n";
+    out << "    \"library_build_type\": \"release\"\n  },\n";
+    out << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        char times[128];
+        std::snprintf(times, sizeof(times), "\"real_time\": %.6e, \"cpu_time\": %.6e", result.realTime, result.cpuTime);
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << Quoted(result.name)
+            << ", \"run_type\": \"iteration\", \"iterations\": " << result.iterations
+            << ", " << times << ", \"time_unit\": \"ns\"}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+
+// Flags follow Google Benchmark: --benchmark_filter=<regex>, --benchmark_min_time=<seconds>,
+// --benchmark_out=<file> (JSON; stdout if absent), plus --threads=<n> (0 = all cores)
+// and --max_size=<n> to skip the largest sizes.
+int main(int argc, char** argv) {
+    std::regex filter(".*");
+    double minTime = 0.5;
+    std::string outPath;
+    size_t maxSize = -1;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const size_t equals = arg.find('=');
+        const std::string key = arg.substr(0, equals);
+        const std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+        if (key == "--benchmark_filter")
+            filter = std::regex(value);
+        else if (key == "--benchmark_min_time")
+            minTime = std::stod(value);
+        else if (key == "--benchmark_out")
+            outPath = value;
+        else if (key == "--threads")
+            task::parallel::setThreadsCount(std::stoul(value));
+        else if (key == "--max_size")
+            maxSize = std::stoul(value);
+        else {
+            std::cerr << "Unknown flag " << arg << '\n';
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    std::fprintf(stderr, "%-36s %16s %16s %12s\n", "Benchmark", "Time (ns)", "CPU (ns)", "Iterations");
+    for (const Benchmark& benchmark : Registry()) {
+        for (size_t size : benchmark.sizes) {
+            const std::string name = benchmark.name + "/" + std::to_string(size);
+            if (size > maxSize || !std::regex_search(name, filter))
+                continue;
+            results.push_back(Run(benchmark, size, minTime));
+            const Result& result = results.back();
+            std::fprintf(stderr, "%-36s %16.0f %16.0f %12zu\n",
+                         result.name.c_str(), result.realTime, result.cpuTime, result.iterations);
+        }
+    }
+
+    if (outPath.empty()) {
+        WriteJson(std::cout, results);
+    } else {
+        std::ofstream out(outPath);
+        WriteJson(out, results);
+    }
+    return 0;
+}
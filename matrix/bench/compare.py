@@ -0,0 +1,42 @@
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as file:
+        results = json.load(file)
+    return {bench['name']: bench for bench in results['benchmarks'] if bench.get('run_type', 'iteration') == 'iteration'}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare two benchmark JSON files and flag slowdowns.')
+    parser.add_argument('baseline')
+    parser.add_argument('current')
+    parser.add_argument('--threshold', type=float, default=0.10,
+                        help='relative real-time slowdown that counts as a regression (default 0.10)')
+    args = parser.parse_args()
+
+    baseline, current = load(args.baseline), load(args.current)
+    regressions = []
+    print('%-36s %14s %14s %9s' % ('Benchmark', 'Baseline (ns)', 'Current (ns)', 'Change'))
+    for name, bench in current.items():
+        if name not in baseline:
+            print('%-36s %14s %14.0f %9s' % (name, '-', bench['real_time'], 'new'))
+            continue
+        old, new = baseline[name]['real_time'], bench['real_time']
+        change = new / old - 1. if old > 0 else 0.
+        flag = ''
+        if change > args.threshold:
+            regressions.append(name)
+            flag = '  SLOWER'
+        print('%-36s %14.0f %14.0f %+8.1f%%%s' % (name, old, new, change * 100., flag))
+
+    if regressions:
+        print('\n%d benchmark(s) slowed down by more than %.0f%%: %s'
+              % (len(regressions), args.threshold * 100., ', '.join(regressions)))
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,21 @@
+#!/bin/bash
+
+# Builds and runs the benchmarks, writing bench/results.json. When bench/baseline.json exists the
+# results are compared against it and the script fails on slowdowns above THRESHOLD.
+# To accept the current numbers: cp bench/results.json bench/baseline.json
+# Extra arguments go to the benchmark binary, e.g. --benchmark_filter=Multiply --max_size=1024
+
+set -e
+
+THRESHOLD=0.10
+
+cd "$(dirname "$0")"
+
+g++ -std=c++17 -O2 -pthread -I../ bench.cpp ../src/matrix.cpp ../src/gemm.cpp ../src/simd.cpp ../src/decomposition.cpp ../src/thread_pool.cpp ../src/matrix_io.cpp ../src/sparse.cpp ../src/matrix_memory.cpp ../src/batch.cpp -o matrix_bench
+./matrix_bench --benchmark_out=results.json "$@"
+
+rm matrix_bench
+
+if [ -f baseline.json ]; then
+    python3 compare.py baseline.json results.json --threshold $THRESHOLD
+fi
@@ -4,7 +4,7 @@ set -e
 
 STRESS_TEST_COUNT=500
 
-g++ -std=c++17 -I./ test/test.cpp src/matrix.cpp -o matrix_test
+g++ -std=c++17 -pthread -I./ test/test.cpp src/matrix.cpp src/gemm.cpp src/simd.cpp src/decomposition.cpp src/thread_pool.cpp src/matrix_io.cpp src/sparse.cpp src/matrix_memory.cpp src/batch.cpp -o matrix_test
 python3 test/generate.py $STRESS_TEST_COUNT > test_data
 ./matrix_test $STRESS_TEST_COUNT < test_data
 
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "matrix.h"
+
+namespace task {
+
+    // Dense row-major matrix of any arithmetic T; BasicMatrix<double> is Matrix itself. The
+    // generic template carries the core of Matrix's API (element access, arithmetic, transpose,
+    // trace, det, comparison and text I/O) with storage from the same memory resources, while
+    // decompositions, views, lazy expressions and the SIMD kernels remain double-only. Det,
+    // the elementwise loops and text I/O are the strided.h algorithms Matrix and FixedMatrix use.
+    // Floating-point matrices compare with EPS, integral ones exactly.
+    template<class T>
+    class BasicMatrix {
+        static_assert(std::is_arithmetic<T>::value, "BasicMatrix needs an arithmetic element type");
+
+    private:
+
+        class MatrixRow {
+        private:
+            T* row;
+            size_t cols;
+
+        public:
+            MatrixRow(T* row, size_t cols) : row(row), cols(cols) {}
+
+            T& operator[](const size_t& col) {
+                access::check(col < cols);
+                return row[col];
+            }
+
+            const T& operator[](const size_t& col) const {
+                access::check(col < cols);
+                return row[col];
+            }
+
+        };
+
+        std::pmr::memory_resource* resource;
+        T* matrix;
+        size_t rows, cols;
+
+        T* allocate(size_t count) const {
+            return static_cast<T*>(resource->allocate(std::max<size_t>(count, 1) * sizeof(T), MATRIX_ALIGNMENT));
+        }
+
+        void destroy() {
+            if (matrix)
+                resource->deallocate(matrix, std::max<size_t>(rows * cols, 1) * sizeof(T), MATRIX_ALIGNMENT);
+            matrix = nullptr;
+        }
+
+        // The in-place operations pass their own resource, so the target keeps it.
+        BasicMatrix product(const BasicMatrix& mult, std::pmr::memory_resource* target) const {
+            BasicMatrix buffer(rows, mult.cols, target);
+            strided::multiply(rows, mult.cols, cols, matrix, cols, mult.matrix, mult.cols, buffer.matrix, mult.cols);
+            return buffer;
+        }
+
+        BasicMatrix transposed(std::pmr::memory_resource* target) const {
+            BasicMatrix result(cols, rows, target);
+            strided::transpose(matrix, cols, result.matrix, rows, rows, cols);
+            return result;
+        }
+
+    public:
+        using value_type = T;
+
+        // Same conventions as Matrix: identity-like construction, copies on the default
+        // resource, moves carrying the source's resource along with its buffer.
+        BasicMatrix() : BasicMatrix(1, 1) {}
+
+        explicit BasicMatrix(const size_t& rows, const size_t& cols, std::pmr::memory_resource* resource = nullptr)
+            : resource(resource ? resource : getDefaultMatrixResource()), matrix(allocate(rows * cols)),
+              rows(rows), cols(cols) {
+            std::fill(matrix, matrix + rows * cols, T(0));
+            for (size_t i = 0; i < rows && i < cols; ++i)
+                matrix[i * cols + i] = T(1);
+        }
+
+        BasicMatrix(const BasicMatrix& copy)
+            : resource(getDefaultMatrixResource()), matrix(allocate(copy.rows * copy.cols)),
+              rows(copy.rows), cols(copy.cols) {
+            std::copy(copy.matrix, copy.matrix + rows * cols, matrix);
+        }
+
+        BasicMatrix(BasicMatrix&& other) noexcept
+            : resource(other.resource), matrix(other.matrix), rows(other.rows), cols(other.cols) {
+            other.matrix = nullptr;
+            other.rows = other.cols = 0;
+        }
+
+        // Element-wise static_cast from a matrix of another type, Matrix included.
+        template<class U>
+        explicit BasicMatrix(const BasicMatrix<U>& other) : BasicMatrix(other.getRowsCount(), other.getColumnsCount()) {
+            for (size_t i = 0; i < rows; ++i)
+                for (size_t j = 0; j < cols; ++j)
+                    matrix[i * cols + j] = static_cast<T>(other.uncheckedAt(i, j));
+        }
+
+        ~BasicMatrix() {
+            destroy();
+        }
+
+        BasicMatrix& operator=(const BasicMatrix& copy) {
+            if (&copy == this)
+                return *this;
+            if (rows * cols != copy.rows * copy.cols) {
+                destroy();
+                matrix = allocate(copy.rows * copy.cols);
+            }
+            rows = copy.rows;
+            cols = copy.cols;
+            std::copy(copy.matrix, copy.matrix + rows * cols, matrix);
+            return *this;
+        }
+
+        BasicMatrix& operator=(BasicMatrix&& other) noexcept {
+            if (&other == this)
+                return *this;
+            destroy();
+            resource = other.resource;
+            matrix = other.matrix;
+            rows = other.rows;
+            cols = other.cols;
+            other.matrix = nullptr;
+            other.rows = other.cols = 0;
+            return *this;
+        }
+
+        size_t getRowsCount() const { return rows; }
+        size_t getColumnsCount() const { return cols; }
+
+        T& get(const size_t& row, const size_t& col) {
+            access::check(row < rows && col < cols);
+            return matrix[row * cols + col];
+        }
+
+        const T& get(const size_t& row, const size_t& col) const {
+            access::check(row < rows && col < cols);
+            return matrix[row * cols + col];
+        }
+
+        void set(const size_t& row, const size_t& col, const T& value) { get(row, col) = value; }
+
+        // Never checked, in any build. Rows are contiguous, so getStride() is the column count.
+        T& uncheckedAt(const size_t& row, const size_t& col) { return matrix[row * cols + col]; }
+        const T& uncheckedAt(const size_t& row, const size_t& col) const { return matrix[row * cols + col]; }
+        T* getData() { return matrix; }
+        const T* getData() const { return matrix; }
+        size_t getStride() const { return cols; }
+        std::pmr::memory_resource* getResource() const { return resource; }
+
+        // Keeps the overlapping elements and zero-fills the rest.
+        void resize(const size_t& newRows, const size_t& newCols) {
+            if (newRows == rows && newCols == cols)
+                return;
+            T* newMatrix = allocate(newRows * newCols);
+            std::fill(newMatrix, newMatrix + newRows * newCols, T(0));
+            for (size_t i = 0; i < std::min(rows, newRows); ++i)
+                std::copy(matrix + i * cols, matrix + i * cols + std::min(cols, newCols), newMatrix + i * newCols);
+            destroy();
+            matrix = newMatrix;
+            rows = newRows;
+            cols = newCols;
+        }
+
+        MatrixRow operator[](const size_t& row) {
+            access::check(row < rows);
+            return MatrixRow(matrix + row * cols, cols);
+        }
+
+        const MatrixRow operator[](const size_t& row) const {
+            access::check(row < rows);
+            return MatrixRow(matrix + row * cols, cols);
+        }
+
+        BasicMatrix& operator+=(const BasicMatrix& add) {
+            if (add.rows != rows || add.cols != cols)
+                throw SizeMismatchException();
+            strided::combine(matrix, cols, add.matrix, cols, matrix, cols, rows, cols, std::plus<T>());
+            return *this;
+        }
+
+        BasicMatrix& operator-=(const BasicMatrix& diff) {
+            if (diff.rows != rows || diff.cols != cols)
+                throw SizeMismatchException();
+            strided::combine(matrix, cols, diff.matrix, cols, matrix, cols, rows, cols, std::minus<T>());
+            return *this;
+        }
+
+        BasicMatrix& operator*=(const BasicMatrix& mult) {
+            if (mult.rows != cols)
+                throw SizeMismatchException();
+            return *this = product(mult, resource);
+        }
+
+        BasicMatrix& operator*=(const T& number) {
+            strided::apply(matrix, cols, matrix, cols, rows, cols, [number](T value) { return value * number; });
+            return *this;
+        }
+
+        BasicMatrix operator+(const BasicMatrix& add) const { return BasicMatrix(*this) += add; }
+        BasicMatrix operator-(const BasicMatrix& diff) const { return BasicMatrix(*this) -= diff; }
+        BasicMatrix operator*(const T& number) const { return BasicMatrix(*this) *= number; }
+
+        BasicMatrix operator*(const BasicMatrix& mult) const {
+            if (mult.rows != cols)
+                throw SizeMismatchException();
+            return product(mult, nullptr);
+        }
+
+        BasicMatrix operator-() const { return BasicMatrix(*this) *= T(-1); }
+        BasicMatrix operator+() const { return *this; }
+
+        // strided::det: partial pivoting for floating-point T, Bareiss elimination for integral T.
+        T det() const {
+            if (rows != cols || rows == 0)
+                throw SizeMismatchException();
+            BasicMatrix buffer(*this);
+            return strided::det(buffer.matrix, cols, rows);
+        }
+
+        void transpose() {
+            *this = transposed(resource);
+        }
+
+        BasicMatrix transposed() const {
+            return transposed(nullptr);
+        }
+
+        T trace() const {
+            if (rows != cols || rows == 0)
+                throw SizeMismatchException();
+            return strided::trace(matrix, cols, rows);
+        }
+
+        std::vector<T> getRow(const size_t& row) {
+            if (row >= rows)
+                throw OutOfBoundsException();
+            return std::vector<T>(matrix + row * cols, matrix + (row + 1) * cols);
+        }
+
+        std::vector<T> getColumn(const size_t& col) {
+            if (col >= cols)
+                throw OutOfBoundsException();
+            return strided::column(matrix, cols, rows, col);
+        }
+
+        bool operator==(const BasicMatrix& comp) const {
+            if (rows != comp.rows || cols != comp.cols)
+                return false;
+            return strided::equal(matrix, cols, comp.matrix, cols, rows, cols, EPS);
+        }
+
+        bool operator!=(const BasicMatrix& comp) const {
+            return !(*this == comp);
+        }
+
+    };
+
+    template<class T>
+    BasicMatrix<T> operator*(const typename BasicMatrix<T>::value_type& number, const BasicMatrix<T>& mult) {
+        return mult * number;
+    }
+
+    template<class U>
+    Matrix::BasicMatrix(const BasicMatrix<U>& other) : BasicMatrix(other.getRowsCount(), other.getColumnsCount()) {
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t j = 0; j < cols; ++j)
+                matrix[i * stride + j] = static_cast<double>(other.uncheckedAt(i, j));
+    }
+
+    // Like Matrix's operator<<: only the values, one row per line, without the size; operator>>
+    // expects the size before them.
+    template<class T>
+    std::ostream& operator<<(std::ostream& out, const BasicMatrix<T>& matrix) {
+        return strided::write(out, matrix.getData(), matrix.getStride(), matrix.getRowsCount(), matrix.getColumnsCount());
+    }
+
+    template<class T>
+    std::istream& operator>>(std::istream& in, BasicMatrix<T>& matrix) {
+        return strided::read(in, matrix);
+    }
+
+    using FloatMatrix = BasicMatrix<float>;
+    using Int32Matrix = BasicMatrix<int32_t>;
+    using Int64Matrix = BasicMatrix<int64_t>;
+
+}  // namespace task
@@ -0,0 +1,150 @@
+#include "batch.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace task {
+
+    MatrixBatch::MatrixBatch(size_t count, size_t rows, size_t cols, std::pmr::memory_resource* resource)
+        : resource(resource ? resource : getDefaultMatrixResource()), data(nullptr), count(count),
+          rows(rows), cols(cols), stride((count + simd::BATCH_LANES - 1) / simd::BATCH_LANES * simd::BATCH_LANES) {
+        data = allocate();
+        std::fill(data, data + rows * cols * stride, 0.);
+        for (size_t i = 0; i < rows && i < cols; ++i)
+            std::fill(getLane(i, i), getLane(i, i) + stride, 1.);
+    }
+
+    MatrixBatch::MatrixBatch(const MatrixBatch& copy)
+        : resource(getDefaultMatrixResource()), data(nullptr), count(copy.count),
+          rows(copy.rows), cols(copy.cols), stride(copy.stride) {
+        data = allocate();
+        std::copy(copy.data, copy.data + rows * cols * stride, data);
+    }
+
+    MatrixBatch& MatrixBatch::operator=(const MatrixBatch& copy) {
+        if (&copy == this)
+            return *this;
+        const bool sameSize = rows * cols * stride == copy.rows * copy.cols * copy.stride;
+        if (!sameSize)
+            destroy();
+        count = copy.count;
+        rows = copy.rows;
+        cols = copy.cols;
+        stride = copy.stride;
+        if (!sameSize)
+            data = allocate();
+        std::copy(copy.data, copy.data + rows * cols * stride, data);
+        return *this;
+    }
+
+    MatrixBatch::MatrixBatch(MatrixBatch&& other) noexcept
+        : resource(other.resource), data(other.data), count(other.count),
+          rows(other.rows), cols(other.cols), stride(other.stride) {
+        other.data = nullptr;
+        other.count = other.rows = other.cols = other.stride = 0;
+    }
+
+    MatrixBatch& MatrixBatch::operator=(MatrixBatch&& other) noexcept {
+        if (&other == this)
+            return *this;
+        destroy();
+        resource = other.resource;
+        data = other.data;
+        count = other.count;
+        rows = other.rows;
+        cols = other.cols;
+        stride = other.stride;
+        other.data = nullptr;
+        other.count = other.rows = other.cols = other.stride = 0;
+        return *this;
+    }
+
+    MatrixBatch::~MatrixBatch() {
+        destroy();
+    }
+
+    double* MatrixBatch::allocate() const {
+        const size_t size = std::max<size_t>(rows * cols * stride, 1) * sizeof(double);
+        return static_cast<double*>(resource->allocate(size, MATRIX_ALIGNMENT));
+    }
+
+    void MatrixBatch::destroy() {
+        if (data)
+            resource->deallocate(data, std::max<size_t>(rows * cols * stride, 1) * sizeof(double), MATRIX_ALIGNMENT);
+        data = nullptr;
+    }
+
+    double& MatrixBatch::get(size_t index, size_t row, size_t col) {
+        access::check(index < count && row < rows && col < cols);
+        return getLane(row, col)[index];
+    }
+
+    const double& MatrixBatch::get(size_t index, size_t row, size_t col) const {
+        access::check(index < count && row < rows && col < cols);
+        return getLane(row, col)[index];
+    }
+
+    Matrix MatrixBatch::getMatrix(size_t index) const {
+        access::check(index < count);
+        Matrix result(rows, cols);
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t j = 0; j < cols; ++j)
+                result.uncheckedAt(i, j) = getLane(i, j)[index];
+        return result;
+    }
+
+    void MatrixBatch::setMatrix(size_t index, const Matrix& matrix) {
+        access::check(index < count);
+        if (matrix.getRowsCount() != rows || matrix.getColumnsCount() != cols)
+            throw SizeMismatchException();
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t j = 0; j < cols; ++j)
+                getLane(i, j)[index] = matrix.uncheckedAt(i, j);
+    }
+
+    MatrixBatch batchedMultiply(const MatrixBatch& left, const MatrixBatch& right) {
+        if (left.getCount() != right.getCount() || left.getColumnsCount() != right.getRowsCount())
+            throw SizeMismatchException();
+        const size_t m = left.getRowsCount(), k = left.getColumnsCount(), n = right.getColumnsCount();
+        MatrixBatch result(left.getCount(), m, n);
+        parallel::forRange(result.getStride() / simd::BATCH_LANES, m * n * k * simd::BATCH_LANES, [&](size_t begin, size_t end) {
+            for (size_t tile = begin; tile < end; ++tile) {
+                const size_t offset = tile * simd::BATCH_LANES;
+                simd::batchMultiply(left.getLane(0, 0) + offset, left.getStride(),
+                                    right.getLane(0, 0) + offset, right.getStride(),
+                                    result.getLane(0, 0) + offset, result.getStride(), m, k, n);
+            }
+        });
+        return result;
+    }
+
+    std::vector<double> batchedDet(const MatrixBatch& batch) {
+        const size_t n = batch.getRowsCount();
+        if (n != batch.getColumnsCount())
+            throw SizeMismatchException();
+        const size_t tiles = batch.getStride() / simd::BATCH_LANES;
+        std::vector<double> result(tiles * simd::BATCH_LANES);
+        parallel::forRange(tiles, n * n * n * simd::BATCH_LANES, [&](size_t begin, size_t end) {
+            std::vector<double> scratch(n * n * simd::BATCH_LANES);
+            for (size_t tile = begin; tile < end; ++tile) {
+                const size_t offset = tile * simd::BATCH_LANES;
+                simd::batchDet(batch.getLane(0, 0) + offset, batch.getStride(), n, result.data() + offset, scratch.data());
+            }
+        });
+        result.resize(batch.getCount());
+        return result;
+    }
+
+    MatrixBatch batchedTranspose(const MatrixBatch& batch) {
+        const size_t rows = batch.getRowsCount(), cols = batch.getColumnsCount();
+        MatrixBatch result(batch.getCount(), cols, rows);
+        parallel::forRange(rows * cols, batch.getStride(), [&](size_t begin, size_t end) {
+            for (size_t e = begin; e < end; ++e) {
+                const double* lane = batch.getLane(e / cols, e % cols);
+                std::copy(lane, lane + batch.getStride(), result.getLane(e % cols, e / cols));
+            }
+        });
+        return result;
+    }
+
+}  // namespace task
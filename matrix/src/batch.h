@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+#include "matrix.h"
+
+namespace task {
+
+    // Many matrices of one shape in a structure-of-arrays layout: element (i, j) of every matrix
+    // is stored contiguously, so the batched operations below vectorize across the matrices
+    // instead of within one of them, which is what pays off for orders like 4 to 32. The count
+    // is padded to a multiple of simd::BATCH_LANES; the padding matrices are never visible.
+    class MatrixBatch {
+    private:
+        std::pmr::memory_resource* resource;
+        double* data;
+        size_t count, rows, cols, stride;
+
+        double* allocate() const;
+        void destroy();
+
+    public:
+        // Every matrix starts identity-like, as in Matrix(rows, cols).
+        MatrixBatch(size_t count, size_t rows, size_t cols, std::pmr::memory_resource* = nullptr);
+        MatrixBatch(const MatrixBatch&);
+        MatrixBatch& operator=(const MatrixBatch&);
+        MatrixBatch(MatrixBatch&&) noexcept;
+        MatrixBatch& operator=(MatrixBatch&&) noexcept;
+        ~MatrixBatch();
+
+        size_t getCount() const { return count; }
+        size_t getRowsCount() const { return rows; }
+        size_t getColumnsCount() const { return cols; }
+
+        // Element (row, col) of the matrix at index.
+        double& get(size_t index, size_t row, size_t col);
+        const double& get(size_t index, size_t row, size_t col) const;
+
+        // Element (row, col) of all matrices, getCount() consecutive doubles (never checked).
+        double* getLane(size_t row, size_t col) { return data + (row * cols + col) * stride; }
+        const double* getLane(size_t row, size_t col) const { return data + (row * cols + col) * stride; }
+        size_t getStride() const { return stride; }
+
+        Matrix getMatrix(size_t index) const;
+        void setMatrix(size_t index, const Matrix&);
+
+        std::pmr::memory_resource* getResource() const { return resource; }
+    };
+
+    // Products of corresponding matrices; both batches must have the same count and
+    // multipliable shapes, otherwise SizeMismatchException is thrown.
+    MatrixBatch batchedMultiply(const MatrixBatch&, const MatrixBatch&);
+
+    // Determinants of square matrices, computed by LU with partial pivoting.
+    std::vector<double> batchedDet(const MatrixBatch&);
+
+    MatrixBatch batchedTranspose(const MatrixBatch&);
+
+}  // namespace task
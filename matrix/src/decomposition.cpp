@@ -0,0 +1,386 @@
+#include "matrix.h"
+#include "gemm.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace task {
+
+    namespace {
+
+        // Column width of the panels factorized before one blocked trailing update.
+        const size_t PANEL = 64;
+
+        // C -= A * B for an m x k block A and a k x n block B, one MC-row block of C at a time
+        // through the packed product kernel. With `lower` only the part of every block up to
+        // its last row's diagonal is updated, which is all a symmetric update needs.
+        void subtractProduct(size_t m, size_t n, size_t k, const double* a, size_t lda,
+                             const double* b, size_t ldb, double* c, size_t ldc, bool lower) {
+            if (m == 0 || n == 0 || k == 0)
+                return;
+            const size_t blocks = (m + gemm::MC - 1) / gemm::MC;
+            parallel::forRange(blocks, gemm::MC * n * k, [&](size_t begin, size_t end) {
+                std::vector<double> product(gemm::MC * n);
+                for (size_t block = begin; block < end; ++block) {
+                    const size_t row = block * gemm::MC;
+                    const size_t height = std::min(gemm::MC, m - row);
+                    const size_t width = lower ? std::min(n, row + height) : n;
+                    gemm::multiply(height, width, k, a + row * lda, lda, b, ldb, product.data(), width);
+                    for (size_t i = 0; i < height; ++i)
+                        simd::subtract(c + (row + i) * ldc, product.data() + i * width, c + (row + i) * ldc, width);
+                }
+            });
+        }
+
+    }  // namespace
+
+    // Right-looking blocked LU: a PANEL-wide column panel is factorized with partial pivoting,
+    // the rows to its right are solved against its unit lower triangle, and the trailing
+    // submatrix gets one rank-PANEL update through the packed product kernel.
+    LUDecomposition::LUDecomposition(const Matrix& source)
+        : lu(source), permutation(source.rows), swapsOdd(false), singular(false) {
+        if (lu.rows != lu.cols || lu.rows == 0)
+            throw SizeMismatchException();
+        const size_t size = lu.rows;
+        const size_t stride = lu.stride;
+        double* data = lu.matrix;
+        for (size_t i = 0; i < size; ++i)
+            permutation[i] = i;
+        for (size_t panel = 0; panel < size; panel += PANEL) {
+            const size_t panelEnd = std::min(size, panel + PANEL);
+            for (size_t k = panel; k < panelEnd; ++k) {
+                size_t pivot = k;
+                double best = std::fabs(data[k * stride + k]);
+                for (size_t i = k + 1; i < size; ++i)
+                    if (std::fabs(data[i * stride + k]) > best) {
+                        best = std::fabs(data[i * stride + k]);
+                        pivot = i;
+                    }
+                if (best == 0) {
+                    singular = true;
+                    continue;
+                }
+                if (pivot != k) {
+                    std::swap_ranges(data + k * stride, data + k * stride + size, data + pivot * stride);
+                    std::swap(permutation[k], permutation[pivot]);
+                    swapsOdd = !swapsOdd;
+                }
+                const double* pivotRow = data + k * stride;
+                parallel::forRange(size - k - 1, panelEnd - k, [&](size_t begin, size_t end) {
+                    for (size_t i = k + 1 + begin; i < k + 1 + end; ++i) {
+                        double* row = data + i * stride;
+                        const double factor = row[k] /= pivotRow[k];
+                        for (size_t j = k + 1; j < panelEnd; ++j)
+                            row[j] -= factor * pivotRow[j];
+                    }
+                });
+            }
+            if (panelEnd == size)
+                break;
+            for (size_t i = panel + 1; i < panelEnd; ++i) {
+                double* row = data + i * stride;
+                for (size_t k = panel; k < i; ++k) {
+                    const double factor = row[k];
+                    const double* solved = data + k * stride;
+                    for (size_t j = panelEnd; j < size; ++j)
+                        row[j] -= factor * solved[j];
+                }
+            }
+            subtractProduct(size - panelEnd, size - panelEnd, panelEnd - panel,
+                            data + panelEnd * stride + panel, stride, data + panel * stride + panelEnd, stride,
+                            data + panelEnd * stride + panelEnd, stride, false);
+        }
+    }
+
+    const Matrix& LUDecomposition::getLU() const {
+        return lu;
+    }
+
+    const std::vector<size_t>& LUDecomposition::getPermutation() const {
+        return permutation;
+    }
+
+    bool LUDecomposition::isSingular() const {
+        return singular;
+    }
+
+    double LUDecomposition::det() const {
+        if (singular)
+            return 0;
+        double result = 1;
+        for (size_t i = 0; i < lu.rows; ++i)
+            result *= lu.matrix[i * lu.stride + i];
+        return swapsOdd ? -result : result;
+    }
+
+    Matrix LUDecomposition::solve(const Matrix& rhs) const {
+        if (rhs.rows != lu.rows)
+            throw SizeMismatchException();
+        if (singular)
+            throw SingularMatrixException();
+        const size_t size = lu.rows;
+        const size_t count = rhs.cols;
+        Matrix result(size, count);
+        double* x = result.matrix;
+        const size_t xStride = result.stride;
+        for (size_t i = 0; i < size; ++i) {
+            const double* source = rhs.matrix + permutation[i] * rhs.stride;
+            std::copy(source, source + count, x + i * xStride);
+        }
+        for (size_t i = 1; i < size; ++i) {
+            double* row = x + i * xStride;
+            for (size_t k = 0; k < i; ++k) {
+                const double factor = lu.matrix[i * lu.stride + k];
+                const double* solved = x + k * xStride;
+                for (size_t j = 0; j < count; ++j)
+                    row[j] -= factor * solved[j];
+            }
+        }
+        for (size_t i = size; i-- > 0;) {
+            double* row = x + i * xStride;
+            for (size_t k = i + 1; k < size; ++k) {
+                const double factor = lu.matrix[i * lu.stride + k];
+                const double* solved = x + k * xStride;
+                for (size_t j = 0; j < count; ++j)
+                    row[j] -= factor * solved[j];
+            }
+            const double pivot = lu.matrix[i * lu.stride + i];
+            for (size_t j = 0; j < count; ++j)
+                row[j] /= pivot;
+        }
+        return result;
+    }
+
+    // Right-looking blocked Cholesky on the lower triangle, with the same panels as LU; the
+    // trailing update only touches blocks on or below the diagonal.
+    CholeskyDecomposition::CholeskyDecomposition(const Matrix& source) : l(source) {
+        if (l.rows != l.cols || l.rows == 0)
+            throw SizeMismatchException();
+        const size_t size = l.rows;
+        const size_t stride = l.stride;
+        double* data = l.matrix;
+        for (size_t panel = 0; panel < size; panel += PANEL) {
+            const size_t panelEnd = std::min(size, panel + PANEL);
+            for (size_t k = panel; k < panelEnd; ++k) {
+                const double pivot = data[k * stride + k];
+                if (!(pivot > 0))
+                    throw NotPositiveDefiniteException();
+                const double root = data[k * stride + k] = std::sqrt(pivot);
+                for (size_t i = k + 1; i < size; ++i)
+                    data[i * stride + k] /= root;
+                parallel::forRange(size - k - 1, panelEnd - k, [&](size_t begin, size_t end) {
+                    for (size_t i = k + 1 + begin; i < k + 1 + end; ++i) {
+                        double* row = data + i * stride;
+                        for (size_t j = k + 1; j < panelEnd && j <= i; ++j)
+                            row[j] -= row[k] * data[j * stride + k];
+                    }
+                });
+            }
+            if (panelEnd == size)
+                break;
+            const size_t rest = size - panelEnd, width = panelEnd - panel;
+            Matrix transposedPanel(width, rest);
+            simd::transpose(data + panelEnd * stride + panel, stride, transposedPanel.matrix, transposedPanel.stride,
+                            rest, width);
+            subtractProduct(rest, rest, width, data + panelEnd * stride + panel, stride,
+                            transposedPanel.matrix, transposedPanel.stride, data + panelEnd * stride + panelEnd, stride, true);
+        }
+        for (size_t i = 0; i < size; ++i)
+            std::fill(data + i * stride + i + 1, data + (i + 1) * stride, 0.);
+    }
+
+    const Matrix& CholeskyDecomposition::getL() const {
+        return l;
+    }
+
+    double CholeskyDecomposition::det() const {
+        double result = 1;
+        for (size_t i = 0; i < l.rows; ++i)
+            result *= l.matrix[i * l.stride + i];
+        return result * result;
+    }
+
+    Matrix CholeskyDecomposition::solve(const Matrix& rhs) const {
+        if (rhs.rows != l.rows)
+            throw SizeMismatchException();
+        const size_t size = l.rows;
+        const size_t count = rhs.cols;
+        Matrix result(rhs);
+        double* x = result.matrix;
+        const size_t xStride = result.stride;
+        for (size_t i = 0; i < size; ++i) {
+            double* row = x + i * xStride;
+            for (size_t k = 0; k < i; ++k) {
+                const double factor = l.matrix[i * l.stride + k];
+                const double* solved = x + k * xStride;
+                for (size_t j = 0; j < count; ++j)
+                    row[j] -= factor * solved[j];
+            }
+            const double pivot = l.matrix[i * l.stride + i];
+            for (size_t j = 0; j < count; ++j)
+                row[j] /= pivot;
+        }
+        for (size_t i = size; i-- > 0;) {
+            double* row = x + i * xStride;
+            for (size_t k = i + 1; k < size; ++k) {
+                const double factor = l.matrix[k * l.stride + i];
+                const double* solved = x + k * xStride;
+                for (size_t j = 0; j < count; ++j)
+                    row[j] -= factor * solved[j];
+            }
+            const double pivot = l.matrix[i * l.stride + i];
+            for (size_t j = 0; j < count; ++j)
+                row[j] /= pivot;
+        }
+        return result;
+    }
+
+    // Householder QR with column pivoting (LAPACK's geqp3 without the blocking): every step
+    // brings the remaining column of largest norm to the front, so |R(k, k)| never grows and
+    // the rank can be read off the diagonal. Column norms are downdated and recomputed only
+    // when cancellation has eaten most of them.
+    QRDecomposition::QRDecomposition(const Matrix& source)
+        : qr(source), tau(std::min(source.rows, source.cols)), permutation(source.cols), rank(0) {
+        const size_t rows = qr.rows, cols = qr.cols;
+        const size_t stride = qr.stride;
+        double* data = qr.matrix;
+        std::vector<double> norms(cols, 0.), fullNorms(cols);
+        for (size_t j = 0; j < cols; ++j)
+            permutation[j] = j;
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t j = 0; j < cols; ++j)
+                norms[j] += data[i * stride + j] * data[i * stride + j];
+        fullNorms = norms;
+        for (size_t k = 0; k < tau.size(); ++k) {
+            const size_t pivot = std::max_element(norms.begin() + k, norms.end()) - norms.begin();
+            if (pivot != k) {
+                for (size_t i = 0; i < rows; ++i)
+                    std::swap(data[i * stride + k], data[i * stride + pivot]);
+                std::swap(norms[k], norms[pivot]);
+                std::swap(fullNorms[k], fullNorms[pivot]);
+                std::swap(permutation[k], permutation[pivot]);
+            }
+            double tail = 0.;
+            for (size_t i = k + 1; i < rows; ++i)
+                tail += data[i * stride + k] * data[i * stride + k];
+            const double head = data[k * stride + k];
+            tau[k] = 0.;
+            if (tail != 0.) {
+                const double beta = head > 0 ? -std::sqrt(head * head + tail) : std::sqrt(head * head + tail);
+                tau[k] = (beta - head) / beta;
+                for (size_t i = k + 1; i < rows; ++i)
+                    data[i * stride + k] /= head - beta;
+                data[k * stride + k] = beta;
+                parallel::forRange(cols - k - 1, rows - k, [&](size_t begin, size_t end) {
+                    const size_t first = k + 1 + begin, last = k + 1 + end;
+                    std::vector<double> w(data + k * stride + first, data + k * stride + last);
+                    for (size_t i = k + 1; i < rows; ++i) {
+                        const double v = data[i * stride + k];
+                        for (size_t j = first; j < last; ++j)
+                            w[j - first] += v * data[i * stride + j];
+                    }
+                    for (size_t j = first; j < last; ++j)
+                        data[k * stride + j] -= tau[k] * w[j - first];
+                    for (size_t i = k + 1; i < rows; ++i) {
+                        const double v = tau[k] * data[i * stride + k];
+                        for (size_t j = first; j < last; ++j)
+                            data[i * stride + j] -= v * w[j - first];
+                    }
+                });
+            }
+            for (size_t j = k + 1; j < cols; ++j) {
+                norms[j] -= data[k * stride + j] * data[k * stride + j];
+                if (norms[j] <= EPS * fullNorms[j]) {
+                    norms[j] = 0.;
+                    for (size_t i = k + 1; i < rows; ++i)
+                        norms[j] += data[i * stride + j] * data[i * stride + j];
+                    fullNorms[j] = norms[j];
+                }
+            }
+        }
+        const double largest = tau.empty() ? 0. : std::fabs(data[0]);
+        while (rank < tau.size() && std::fabs(data[rank * stride + rank]) > EPS * largest)
+            ++rank;
+    }
+
+    Matrix QRDecomposition::getQ() const {
+        const size_t rows = qr.rows, reflectors = tau.size();
+        Matrix result = Matrix::zeros(rows, reflectors);
+        for (size_t j = 0; j < reflectors; ++j)
+            result.matrix[j * result.stride + j] = 1.;
+        for (size_t k = reflectors; k-- > 0;) {
+            if (tau[k] == 0.)
+                continue;
+            for (size_t j = k; j < reflectors; ++j) {
+                double w = result.matrix[k * result.stride + j];
+                for (size_t i = k + 1; i < rows; ++i)
+                    w += qr.matrix[i * qr.stride + k] * result.matrix[i * result.stride + j];
+                w *= tau[k];
+                result.matrix[k * result.stride + j] -= w;
+                for (size_t i = k + 1; i < rows; ++i)
+                    result.matrix[i * result.stride + j] -= w * qr.matrix[i * qr.stride + k];
+            }
+        }
+        return result;
+    }
+
+    Matrix QRDecomposition::getR() const {
+        Matrix result = Matrix::zeros(tau.size(), qr.cols);
+        for (size_t i = 0; i < tau.size(); ++i)
+            std::copy(qr.matrix + i * qr.stride + i, qr.matrix + i * qr.stride + qr.cols,
+                      result.matrix + i * result.stride + i);
+        return result;
+    }
+
+    const std::vector<size_t>& QRDecomposition::getPermutation() const {
+        return permutation;
+    }
+
+    size_t QRDecomposition::getRank() const {
+        return rank;
+    }
+
+    Matrix QRDecomposition::solve(const Matrix& rhs) const {
+        if (rhs.rows != qr.rows)
+            throw SizeMismatchException();
+        const size_t count = rhs.cols;
+        Matrix y(rhs);
+        std::vector<double> w(count);
+        for (size_t k = 0; k < tau.size(); ++k) {
+            if (tau[k] == 0.)
+                continue;
+            std::copy(y.matrix + k * y.stride, y.matrix + k * y.stride + count, w.begin());
+            for (size_t i = k + 1; i < qr.rows; ++i) {
+                const double v = qr.matrix[i * qr.stride + k];
+                for (size_t j = 0; j < count; ++j)
+                    w[j] += v * y.matrix[i * y.stride + j];
+            }
+            for (size_t j = 0; j < count; ++j)
+                y.matrix[k * y.stride + j] -= tau[k] * w[j];
+            for (size_t i = k + 1; i < qr.rows; ++i) {
+                const double v = tau[k] * qr.matrix[i * qr.stride + k];
+                for (size_t j = 0; j < count; ++j)
+                    y.matrix[i * y.stride + j] -= v * w[j];
+            }
+        }
+        for (size_t i = rank; i-- > 0;) {
+            double* row = y.matrix + i * y.stride;
+            for (size_t k = i + 1; k < rank; ++k) {
+                const double factor = qr.matrix[i * qr.stride + k];
+                const double* solved = y.matrix + k * y.stride;
+                for (size_t j = 0; j < count; ++j)
+                    row[j] -= factor * solved[j];
+            }
+            const double pivot = qr.matrix[i * qr.stride + i];
+            for (size_t j = 0; j < count; ++j)
+                row[j] /= pivot;
+        }
+        Matrix result = Matrix::zeros(qr.cols, count);
+        for (size_t i = 0; i < rank; ++i)
+            std::copy(y.matrix + i * y.stride, y.matrix + i * y.stride + count,
+                      result.matrix + permutation[i] * result.stride);
+        return result;
+    }
+
+}  // namespace task
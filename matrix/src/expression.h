@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+
+namespace task {
+
+    // Dense matrices are BasicMatrix<T>; Matrix, the double instantiation, is a specialization
+    // with the full numeric API, and the generic template in basic_matrix.h covers the rest.
+    template<class T>
+    class BasicMatrix;
+    template<>
+    class BasicMatrix<double>;
+    using Matrix = BasicMatrix<double>;
+
+    // Lazy elementwise arithmetic. An expression is built with lazy(matrix) and the usual
+    // +, -, unary minus and scalar * operators, and is evaluated in a single pass when it is
+    // assigned to (or used to construct) a Matrix. Operands are held by reference, so an
+    // expression must not outlive the matrices it was built from.
+
+    template<class E>
+    class MatrixExpression {
+    public:
+        const E& self() const { return static_cast<const E&>(*this); }
+
+        size_t getRowsCount() const { return self().getRowsCount(); }
+        size_t getColumnsCount() const { return self().getColumnsCount(); }
+
+        double operator()(size_t row, size_t col) const { return self()(row, col); }
+    };
+
+    class MatrixReference : public MatrixExpression<MatrixReference> {
+    private:
+        const double* data;
+        size_t rows, cols, stride;
+
+    public:
+        explicit MatrixReference(const Matrix&);
+
+        size_t getRowsCount() const { return rows; }
+        size_t getColumnsCount() const { return cols; }
+
+        double operator()(size_t row, size_t col) const { return data[row * stride + col]; }
+    };
+
+    template<class L, class R>
+    class MatrixSum : public MatrixExpression<MatrixSum<L, R>> {
+    private:
+        L left;
+        R right;
+
+    public:
+        MatrixSum(const L&, const R&);
+
+        size_t getRowsCount() const { return left.getRowsCount(); }
+        size_t getColumnsCount() const { return left.getColumnsCount(); }
+
+        double operator()(size_t row, size_t col) const { return left(row, col) + right(row, col); }
+    };
+
+    template<class L, class R>
+    class MatrixDifference : public MatrixExpression<MatrixDifference<L, R>> {
+    private:
+        L left;
+        R right;
+
+    public:
+        MatrixDifference(const L&, const R&);
+
+        size_t getRowsCount() const { return left.getRowsCount(); }
+        size_t getColumnsCount() const { return left.getColumnsCount(); }
+
+        double operator()(size_t row, size_t col) const { return left(row, col) - right(row, col); }
+    };
+
+    template<class E>
+    class MatrixScaled : public MatrixExpression<MatrixScaled<E>> {
+    private:
+        E operand;
+        double number;
+
+    public:
+        MatrixScaled(const E& operand, double number) : operand(operand), number(number) {}
+
+        size_t getRowsCount() const { return operand.getRowsCount(); }
+        size_t getColumnsCount() const { return operand.getColumnsCount(); }
+
+        double operator()(size_t row, size_t col) const { return operand(row, col) * number; }
+    };
+
+    template<class E>
+    class MatrixNegation : public MatrixExpression<MatrixNegation<E>> {
+    private:
+        E operand;
+
+    public:
+        explicit MatrixNegation(const E& operand) : operand(operand) {}
+
+        size_t getRowsCount() const { return operand.getRowsCount(); }
+        size_t getColumnsCount() const { return operand.getColumnsCount(); }
+
+        double operator()(size_t row, size_t col) const { return -operand(row, col); }
+    };
+
+    MatrixReference lazy(const Matrix&);
+
+    template<class L, class R>
+    MatrixSum<L, R> operator+(const MatrixExpression<L>&, const MatrixExpression<R>&);
+    template<class L>
+    MatrixSum<L, MatrixReference> operator+(const MatrixExpression<L>&, const Matrix&);
+    template<class R>
+    MatrixSum<MatrixReference, R> operator+(const Matrix&, const MatrixExpression<R>&);
+
+    template<class L, class R>
+    MatrixDifference<L, R> operator-(const MatrixExpression<L>&, const MatrixExpression<R>&);
+    template<class L>
+    MatrixDifference<L, MatrixReference> operator-(const MatrixExpression<L>&, const Matrix&);
+    template<class R>
+    MatrixDifference<MatrixReference, R> operator-(const Matrix&, const MatrixExpression<R>&);
+
+    template<class E>
+    MatrixScaled<E> operator*(const MatrixExpression<E>&, const double&);
+    template<class E>
+    MatrixScaled<E> operator*(const double&, const MatrixExpression<E>&);
+
+    template<class E>
+    MatrixNegation<E> operator-(const MatrixExpression<E>&);
+    template<class E>
+    const E& operator+(const MatrixExpression<E>&);
+
+}  // namespace task
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "matrix.h"
+
+namespace task {
+
+    // Matrix with compile-time dimensions stored inline: no heap allocation, and every
+    // operation is constexpr and unrolled over index sequences. T may be any arithmetic type;
+    // floating-point matrices compare with EPS, integral ones exactly.
+    template<class T, size_t R, size_t C>
+    class FixedMatrix {
+        static_assert(std::is_arithmetic<T>::value, "FixedMatrix needs an arithmetic element type");
+        static_assert(R > 0 && C > 0, "FixedMatrix dimensions must be positive");
+
+        template<class, size_t, size_t>
+        friend class FixedMatrix;
+
+    private:
+        T values[R * C];
+
+        struct ElementsTag {};
+
+        template<class... Args>
+        constexpr explicit FixedMatrix(ElementsTag, Args... args) : values{static_cast<T>(args)...} {}
+
+        template<class F, size_t... K>
+        static constexpr FixedMatrix generate(F element, std::index_sequence<K...>) {
+            return FixedMatrix(ElementsTag(), element(K)...);
+        }
+
+        template<class F>
+        static constexpr FixedMatrix generate(F element) {
+            return generate(element, std::make_index_sequence<R * C>());
+        }
+
+        template<size_t K, size_t... L>
+        constexpr T dot(size_t row, size_t col, const FixedMatrix<T, C, K>& other, std::index_sequence<L...>) const {
+            return ((values[row * C + L] * other.values[L * K + col]) + ...);
+        }
+
+    public:
+        using value_type = T;
+
+        // Identity-like, like Matrix(rows, cols): ones on the main diagonal, zeros elsewhere.
+        constexpr FixedMatrix() : FixedMatrix(generate([](size_t k) { return k / C == k % C ? T(1) : T(0); })) {}
+
+        // Builds a matrix from R * C values given in row-major order.
+        template<class... Args>
+        static constexpr FixedMatrix of(Args... args) {
+            static_assert(sizeof...(Args) == R * C, "FixedMatrix::of needs exactly R * C values");
+            return FixedMatrix(ElementsTag(), args...);
+        }
+
+        explicit FixedMatrix(const Matrix& matrix) : values{} {
+            if (matrix.getRowsCount() != R || matrix.getColumnsCount() != C)
+                throw SizeMismatchException();
+            for (size_t i = 0; i < R; ++i)
+                for (size_t j = 0; j < C; ++j)
+                    values[i * C + j] = static_cast<T>(matrix.get(i, j));
+        }
+
+        Matrix toMatrix() const {
+            Matrix result(R, C);
+            for (size_t i = 0; i < R; ++i)
+                for (size_t j = 0; j < C; ++j)
+                    result.set(i, j, static_cast<double>(values[i * C + j]));
+            return result;
+        }
+
+        constexpr size_t getRowsCount() const { return R; }
+        constexpr size_t getColumnsCount() const { return C; }
+
+        constexpr T& get(size_t row, size_t col) {
+            if (row >= R || col >= C)
+                throw OutOfBoundsException();
+            return values[row * C + col];
+        }
+
+        constexpr const T& get(size_t row, size_t col) const {
+            if (row >= R || col >= C)
+                throw OutOfBoundsException();
+            return values[row * C + col];
+        }
+
+        constexpr void set(size_t row, size_t col, const T& value) { get(row, col) = value; }
+
+        // Unchecked: dimensions are known at compile time, so [][] is plain pointer arithmetic.
+        constexpr T* operator[](size_t row) { return values + row * C; }
+        constexpr const T* operator[](size_t row) const { return values + row * C; }
+
+        constexpr FixedMatrix operator+(const FixedMatrix& other) const {
+            return generate([&](size_t k) { return values[k] + other.values[k]; });
+        }
+
+        constexpr FixedMatrix operator-(const FixedMatrix& other) const {
+            return generate([&](size_t k) { return values[k] - other.values[k]; });
+        }
+
+        constexpr FixedMatrix operator*(const T& number) const {
+            return generate([&](size_t k) { return values[k] * number; });
+        }
+
+        constexpr FixedMatrix operator-() const {
+            return generate([&](size_t k) { return -values[k]; });
+        }
+
+        constexpr FixedMatrix operator+() const {
+            return *this;
+        }
+
+        template<size_t K>
+        constexpr FixedMatrix<T, R, K> operator*(const FixedMatrix<T, C, K>& other) const {
+            return FixedMatrix<T, R, K>::generate([&](size_t k) {
+                return dot(k / K, k % K, other, std::make_index_sequence<C>());
+            });
+        }
+
+        constexpr FixedMatrix& operator+=(const FixedMatrix& other) { return *this = *this + other; }
+        constexpr FixedMatrix& operator-=(const FixedMatrix& other) { return *this = *this - other; }
+        constexpr FixedMatrix& operator*=(const T& number) { return *this = *this * number; }
+        constexpr FixedMatrix& operator*=(const FixedMatrix<T, C, C>& other) { return *this = *this * other; }
+
+        constexpr FixedMatrix<T, C, R> transposed() const {
+            return FixedMatrix<T, C, R>::generate([&](size_t k) { return values[(k % R) * C + k / R]; });
+        }
+
+        constexpr T trace() const {
+            static_assert(R == C, "trace() needs a square matrix");
+            return strided::trace(values, C, R);
+        }
+
+        // strided::det: partial pivoting for floating-point T, Bareiss elimination for integral T.
+        constexpr T det() const {
+            static_assert(R == C, "det() needs a square matrix");
+            FixedMatrix part = *this;
+            return strided::det(part.values, C, R);
+        }
+
+        constexpr bool operator==(const FixedMatrix& other) const {
+            return strided::equal(values, C, other.values, C, R, C, EPS);
+        }
+
+        constexpr bool operator!=(const FixedMatrix& other) const {
+            return !(*this == other);
+        }
+    };
+
+    template<class T, size_t R, size_t C>
+    constexpr FixedMatrix<T, R, C> operator*(const T& number, const FixedMatrix<T, R, C>& matrix) {
+        return matrix * number;
+    }
+
+    using Matrix3f = FixedMatrix<float, 3, 3>;
+    using Matrix4f = FixedMatrix<float, 4, 4>;
+    using Matrix3d = FixedMatrix<double, 3, 3>;
+    using Matrix4d = FixedMatrix<double, 4, 4>;
+    using Matrix3i = FixedMatrix<int32_t, 3, 3>;
+    using Matrix4i = FixedMatrix<int32_t, 4, 4>;
+    using Matrix3l = FixedMatrix<int64_t, 3, 3>;
+    using Matrix4l = FixedMatrix<int64_t, 4, 4>;
+
+}  // namespace task
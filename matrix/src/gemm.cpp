@@ -0,0 +1,226 @@
+#include "gemm.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+
+namespace task {
+
+    namespace gemm {
+
+        namespace {
+
+            // Copies an mc x kc block of A into MR-row panels, each stored column by column.
+            void packA(size_t mc, size_t kc, const double* a, size_t lda, double* packed) {
+                for (size_t ir = 0; ir < mc; ir += MR) {
+                    const size_t mr = std::min(MR, mc - ir);
+                    for (size_t p = 0; p < kc; ++p) {
+                        for (size_t i = 0; i < mr; ++i)
+                            packed[i] = a[(ir + i) * lda + p];
+                        for (size_t i = mr; i < MR; ++i)
+                            packed[i] = 0;
+                        packed += MR;
+                    }
+                }
+            }
+
+            // Copies a kc x nc block of B into NR-column panels, each stored row by row.
+            void packB(size_t kc, size_t nc, const double* b, size_t ldb, double* packed) {
+                for (size_t jr = 0; jr < nc; jr += NR) {
+                    const size_t nr = std::min(NR, nc - jr);
+                    for (size_t p = 0; p < kc; ++p) {
+                        const double* row = b + p * ldb + jr;
+                        for (size_t j = 0; j < nr; ++j)
+                            packed[j] = row[j];
+                        for (size_t j = nr; j < NR; ++j)
+                            packed[j] = 0;
+                        packed += NR;
+                    }
+                }
+            }
+
+            // Multiplies one packed A panel by one packed B panel into an mr x nr tile of C.
+            void microKernel(size_t kc, const double* a, const double* b,
+                             double* c, size_t ldc, size_t mr, size_t nr, bool accumulate) {
+                double tile[MR][NR] = {};
+                for (size_t p = 0; p < kc; ++p) {
+                    for (size_t i = 0; i < MR; ++i) {
+                        const double value = a[i];
+                        for (size_t j = 0; j < NR; ++j)
+                            tile[i][j] += value * b[j];
+                    }
+                    a += MR;
+                    b += NR;
+                }
+                for (size_t i = 0; i < mr; ++i) {
+                    double* row = c + i * ldc;
+                    if (accumulate)
+                        for (size_t j = 0; j < nr; ++j)
+                            row[j] += tile[i][j];
+                    else
+                        for (size_t j = 0; j < nr; ++j)
+                            row[j] = tile[i][j];
+                }
+            }
+
+            std::atomic<size_t> strassenCutoff(STRASSEN_OFF);
+
+            void add(size_t n, const double* a, size_t lda, const double* b, size_t ldb, double* c, size_t ldc) {
+                parallel::forRange(n, n, [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i)
+                        simd::add(a + i * lda, b + i * ldb, c + i * ldc, n);
+                });
+            }
+
+            void subtract(size_t n, const double* a, size_t lda, const double* b, size_t ldb, double* c, size_t ldc) {
+                parallel::forRange(n, n, [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i)
+                        simd::subtract(a + i * lda, b + i * ldb, c + i * ldc, n);
+                });
+            }
+
+            void classic(size_t n, const double* a, size_t lda, const double* b, size_t ldb, double* c, size_t ldc) {
+                parallel::forRange(n, n * n, [&](size_t begin, size_t end) {
+                    multiply(end - begin, n, n, a + begin * lda, lda, b, ldb, c + begin * ldc, ldc);
+                });
+            }
+
+            // Two h x h temporaries per level, where h is half the order at that level.
+            size_t arenaSize(size_t n, size_t cutoff) {
+                if (n <= cutoff || n % 2 != 0)
+                    return 0;
+                return 2 * (n / 2) * (n / 2) + arenaSize(n / 2, cutoff);
+            }
+
+            // Winograd's variant (15 additions) in the schedule of Boyer, Dumas, Pernet and Zhou,
+            // which keeps the seven products in C and two temporaries X and Y.
+            void winograd(size_t n, const double* a, size_t lda, const double* b, size_t ldb,
+                          double* c, size_t ldc, double* arena, size_t cutoff) {
+                if (n <= cutoff || n % 2 != 0) {
+                    classic(n, a, lda, b, ldb, c, ldc);
+                    return;
+                }
+                const size_t h = n / 2;
+                const double *a11 = a, *a12 = a + h, *a21 = a + h * lda, *a22 = a21 + h;
+                const double *b11 = b, *b12 = b + h, *b21 = b + h * ldb, *b22 = b21 + h;
+                double *c11 = c, *c12 = c + h, *c21 = c + h * ldc, *c22 = c21 + h;
+                double* x = arena;
+                double* y = arena + h * h;
+                double* rest = arena + 2 * h * h;
+
+                subtract(h, a11, lda, a21, lda, x, h);                  // S3 = A11 - A21
+                subtract(h, b22, ldb, b12, ldb, y, h);                  // T3 = B22 - B12
+                winograd(h, x, h, y, h, c21, ldc, rest, cutoff);        // P7 = S3 T3
+                add(h, a21, lda, a22, lda, x, h);                       // S1 = A21 + A22
+                subtract(h, b12, ldb, b11, ldb, y, h);                  // T1 = B12 - B11
+                winograd(h, x, h, y, h, c22, ldc, rest, cutoff);        // P5 = S1 T1
+                subtract(h, x, h, a11, lda, x, h);                      // S2 = S1 - A11
+                subtract(h, b22, ldb, y, h, y, h);                      // T2 = B22 - T1
+                winograd(h, x, h, y, h, c12, ldc, rest, cutoff);        // P6 = S2 T2
+                subtract(h, a12, lda, x, h, x, h);                      // S4 = A12 - S2
+                subtract(h, y, h, b21, ldb, y, h);                      // T4 = T2 - B21
+                winograd(h, x, h, b22, ldb, c11, ldc, rest, cutoff);    // P3 = S4 B22
+                winograd(h, a11, lda, b11, ldb, x, h, rest, cutoff);    // P1 = A11 B11
+                add(h, x, h, c12, ldc, c12, ldc);                       // U2 = P1 + P6
+                add(h, c12, ldc, c21, ldc, c21, ldc);                   // U3 = U2 + P7
+                add(h, c12, ldc, c22, ldc, c12, ldc);                   // U4 = U2 + P5
+                add(h, c21, ldc, c22, ldc, c22, ldc);                   // C22 = U3 + P5
+                add(h, c12, ldc, c11, ldc, c12, ldc);                   // C12 = U4 + P3
+                winograd(h, a22, lda, y, h, c11, ldc, rest, cutoff);    // P4 = A22 T4
+                subtract(h, c21, ldc, c11, ldc, c21, ldc);              // C21 = U3 - P4
+                winograd(h, a12, lda, b21, ldb, c11, ldc, rest, cutoff);  // P2 = A12 B21
+                add(h, x, h, c11, ldc, c11, ldc);                       // C11 = P1 + P2
+            }
+
+        }  // namespace
+
+        void multiply(size_t m, size_t n, size_t k,
+                      const double* a, size_t lda, const double* b, size_t ldb, double* c, size_t ldc) {
+            if (m * n * k >= BLOCKED_THRESHOLD)
+                blocked(m, n, k, a, lda, b, ldb, c, ldc);
+            else
+                naive(m, n, k, a, lda, b, ldb, c, ldc);
+        }
+
+        void naive(size_t m, size_t n, size_t k,
+                   const double* a, size_t lda, const double* b, size_t ldb, double* c, size_t ldc) {
+            for (size_t i = 0; i < m; ++i) {
+                double* row = c + i * ldc;
+                std::fill(row, row + n, 0.);
+                for (size_t p = 0; p < k; ++p) {
+                    const double value = a[i * lda + p];
+                    const double* multRow = b + p * ldb;
+                    for (size_t j = 0; j < n; ++j)
+                        row[j] += value * multRow[j];
+                }
+            }
+        }
+
+        void blocked(size_t m, size_t n, size_t k,
+                     const double* a, size_t lda, const double* b, size_t ldb, double* c, size_t ldc) {
+            if (k == 0) {
+                for (size_t i = 0; i < m; ++i)
+                    std::fill(c + i * ldc, c + i * ldc + n, 0.);
+                return;
+            }
+            double* packedA = new double[MC * KC];
+            double* packedB = new double[KC * NC];
+            for (size_t jc = 0; jc < n; jc += NC) {
+                const size_t nc = std::min(NC, n - jc);
+                for (size_t pc = 0; pc < k; pc += KC) {
+                    const size_t kc = std::min(KC, k - pc);
+                    packB(kc, nc, b + pc * ldb + jc, ldb, packedB);
+                    for (size_t ic = 0; ic < m; ic += MC) {
+                        const size_t mc = std::min(MC, m - ic);
+                        packA(mc, kc, a + ic * lda + pc, lda, packedA);
+                        for (size_t jr = 0; jr < nc; jr += NR)
+                            for (size_t ir = 0; ir < mc; ir += MR)
+                                microKernel(kc, packedA + ir * kc, packedB + jr * kc,
+                                            c + (ic + ir) * ldc + jc + jr, ldc,
+                                            std::min(MR, mc - ir), std::min(NR, nc - jr), pc > 0);
+                    }
+                }
+            }
+            delete[] packedA;
+            delete[] packedB;
+        }
+
+        void setStrassenCutoff(size_t cutoff) {
+            strassenCutoff.store(cutoff, std::memory_order_relaxed);
+        }
+
+        size_t getStrassenCutoff() {
+            return strassenCutoff.load(std::memory_order_relaxed);
+        }
+
+        void strassen(size_t n, const double* a, size_t lda, const double* b, size_t ldb, double* c, size_t ldc) {
+            const size_t cutoff = std::max<size_t>(1, strassenCutoff.load(std::memory_order_relaxed));
+            size_t levels = 0, leaf = n;
+            while (leaf > cutoff) {
+                leaf = (leaf + 1) / 2;
+                ++levels;
+            }
+            const size_t padded = leaf << levels;
+            if (padded == n) {
+                double* arena = new double[arenaSize(n, cutoff)];
+                winograd(n, a, lda, b, ldb, c, ldc, arena, cutoff);
+                delete[] arena;
+                return;
+            }
+            const size_t square = padded * padded;
+            double* arena = new double[3 * square + arenaSize(padded, cutoff)];
+            double *paddedA = arena, *paddedB = arena + square, *paddedC = arena + 2 * square;
+            std::fill(arena, arena + 2 * square, 0.);
+            for (size_t i = 0; i < n; ++i) {
+                std::copy(a + i * lda, a + i * lda + n, paddedA + i * padded);
+                std::copy(b + i * ldb, b + i * ldb + n, paddedB + i * padded);
+            }
+            winograd(padded, paddedA, padded, paddedB, padded, paddedC, padded, arena + 3 * square, cutoff);
+            for (size_t i = 0; i < n; ++i)
+                std::copy(paddedC + i * padded, paddedC + i * padded + n, c + i * ldc);
+            delete[] arena;
+        }
+
+    }  // namespace gemm
+
+}  // namespace task
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace task {
+
+    namespace gemm {
+
+        // Products with at least this many multiply-adds go through the blocked kernel.
+        const size_t BLOCKED_THRESHOLD = 64 * 64 * 64;
+
+        // Register tile of the micro-kernel and cache block sizes (in elements).
+        const size_t MR = 4, NR = 8;
+        const size_t MC = 128, KC = 256, NC = 2048;
+
+        // C = A * B for row-major A (m x k), B (k x n) and C (m x n) with row strides lda, ldb, ldc.
+        void multiply(size_t m, size_t n, size_t k,
+                      const double* a, size_t lda, const double* b, size_t ldb, double* c, size_t ldc);
+
+        void naive(size_t m, size_t n, size_t k,
+                   const double* a, size_t lda, const double* b, size_t ldb, double* c, size_t ldc);
+
+        void blocked(size_t m, size_t n, size_t k,
+                     const double* a, size_t lda, const double* b, size_t ldb, double* c, size_t ldc);
+
+        // Square products of an order above the cutoff go through Strassen-Winograd recursion,
+        // which stops and hands over to the blocked kernel once the order drops to the cutoff.
+        // Strassen is less accurate than the classic kernel, so it is opt-in: the cutoff starts
+        // at STRASSEN_OFF and every product is computed classically until it is lowered. The
+        // cutoff is atomic, so it may change while products run on other threads.
+        const size_t STRASSEN_OFF = SIZE_MAX;
+        void setStrassenCutoff(size_t);
+        size_t getStrassenCutoff();
+
+        // C = A * B for n x n matrices with 7 half-size products per level instead of 8. Orders
+        // that do not halve evenly down to the cutoff are zero-padded once at the top, and all
+        // temporaries come from one arena allocated upfront. Rounding error grows with the depth
+        // of the recursion, slightly faster than for the classic kernel.
+        void strassen(size_t n, const double* a, size_t lda, const double* b, size_t ldb, double* c, size_t ldc);
+
+    }  // namespace gemm
+
+}  // namespace task
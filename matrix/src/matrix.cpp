@@ -1,173 +1,201 @@
 #include "matrix.h"
+#include "gemm.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include <algorithm>
 #include <iostream>
+#include <utility>
 
 namespace task {
 
-    Matrix::MatrixRow::MatrixRow(double* row, const size_t& cols) : row(row), cols(cols) {}
+    namespace access {
 
-    double& Matrix::MatrixRow::operator[](const size_t& col) {
-        if (col >= cols)
-            throw OutOfBoundsException();
-        return row[col];
-    }
+#ifdef TASK_MATRIX_UNCHECKED
+        bool uncheckedBuild() {
+            return true;
+        }
+#else
+        bool checkedBuild() {
+            return true;
+        }
+#endif
 
-    const double& Matrix::MatrixRow::operator[](const size_t& col) const {
-        if (col >= cols)
-            throw OutOfBoundsException();
-        return row[col];
+    }  // namespace access
+
+    Matrix::BasicMatrix()
+        : resource(getDefaultMatrixResource()), matrix(allocate(1)), rows(1), cols(1), stride(1), capacity(1) {
+        matrix[0] = 1;
     }
 
-    Matrix::Matrix() : matrix(new double* [1]), rows(1), cols(1) {
-        matrix[0] = new double[1];
-        matrix[0][0] = 1;
+    Matrix::BasicMatrix(const size_t& rows, const size_t& cols, std::pmr::memory_resource* resource)
+        : resource(resource ? resource : getDefaultMatrixResource()), matrix(allocate(rows * cols)),
+          rows(rows), cols(cols), stride(cols), capacity(rows * cols) {
+        std::fill(matrix, matrix + rows * cols, 0.);
+        for (size_t i = 0; i < rows && i < cols; ++i)
+            matrix[i * stride + i] = 1;
     }
 
-    Matrix::Matrix(const size_t& rows, const size_t& cols) : matrix(new double* [rows]), rows(rows), cols(cols) {
-        for (size_t i = 0; i < rows; ++i) {
-            matrix[i] = new double[cols];
-            for (size_t j = 0; j < cols; ++j) {
-                if (i == j)
-                    matrix[i][j] = 1;
-                else
-                    matrix[i][j] = 0;
-            }
-        }
+    Matrix Matrix::zeros(const size_t& rows, const size_t& cols, std::pmr::memory_resource* resource) {
+        Matrix result(rows, cols, resource);
+        for (size_t i = 0; i < rows && i < cols; ++i)
+            result.matrix[i * result.stride + i] = 0;
+        return result;
     }
 
-    Matrix::Matrix(const Matrix& copy) : matrix(new double* [copy.rows]), rows(copy.rows), cols(copy.cols) {
-        for (size_t i = 0; i < rows; ++i) {
-            matrix[i] = new double[cols];
-            for (size_t j = 0; j < cols; ++j)
-                matrix[i][j] = copy.matrix[i][j];
-        }
+    Matrix::BasicMatrix(Borrowed, const double* data, size_t rows, size_t cols)
+        : resource(nullptr), matrix(const_cast<double*>(data)), rows(rows), cols(cols), stride(cols),
+          capacity(rows * cols) {}
+
+    Matrix::BasicMatrix(const Matrix& copy) : Matrix(copy, nullptr) {}
+
+    Matrix::BasicMatrix(const Matrix& copy, std::pmr::memory_resource* resource)
+        : resource(resource ? resource : getDefaultMatrixResource()), matrix(allocate(copy.rows * copy.cols)),
+          rows(copy.rows), cols(copy.cols), stride(copy.cols), capacity(copy.rows * copy.cols) {
+        if (copy.stride == stride)
+            std::copy(copy.matrix, copy.matrix + rows * cols, matrix);
+        else
+            for (size_t i = 0; i < rows; ++i)
+                std::copy(copy.matrix + i * copy.stride, copy.matrix + i * copy.stride + cols, matrix + i * stride);
     }
 
     Matrix& Matrix::operator=(const Matrix& copy) {
         if (&copy == this)
             return *this;
-        destroy();
+        if (capacity < copy.rows * copy.cols) {
+            destroy();
+            matrix = allocate(copy.rows * copy.cols);
+            capacity = copy.rows * copy.cols;
+        }
         rows = copy.rows;
         cols = copy.cols;
-        matrix = new double* [rows];
-        for (size_t i = 0; i < rows; ++i) {
-            matrix[i] = new double[cols];
-            for (size_t j = 0; j < cols; ++j)
-                matrix[i][j] = copy.matrix[i][j];
-        }
+        stride = copy.cols;
+        if (copy.stride == stride)
+            std::copy(copy.matrix, copy.matrix + rows * cols, matrix);
+        else
+            for (size_t i = 0; i < rows; ++i)
+                std::copy(copy.matrix + i * copy.stride, copy.matrix + i * copy.stride + cols, matrix + i * stride);
         return *this;
     }
 
-    Matrix::~Matrix() {
-        destroy();
-    }
-
-    void Matrix::destroy() {
-        if (rows > 0) {
-            if (cols > 0)
-                for (size_t i = 0; i < rows; ++i)
-                    delete[]matrix[i];
-            delete[]matrix;
-        }
+    Matrix::BasicMatrix(Matrix&& other) noexcept
+        : resource(other.resource), matrix(other.matrix), rows(other.rows), cols(other.cols),
+          stride(other.stride), capacity(other.capacity) {
+        other.matrix = nullptr;
+        other.rows = other.cols = other.stride = other.capacity = 0;
     }
 
-    double Matrix::abs(const double& value) const {
-        return value < 0 ? -value : value;
+    Matrix& Matrix::operator=(Matrix&& other) noexcept {
+        if (&other == this)
+            return *this;
+        destroy();
+        resource = other.resource;
+        matrix = other.matrix;
+        rows = other.rows;
+        cols = other.cols;
+        stride = other.stride;
+        capacity = other.capacity;
+        other.matrix = nullptr;
+        other.rows = other.cols = other.stride = other.capacity = 0;
+        return *this;
     }
 
-    size_t Matrix::getRowsCount() const {
-        return rows;
+    Matrix::~BasicMatrix() {
+        destroy();
     }
 
-    size_t Matrix::getColumnsCount() const {
-        return cols;
+    double* Matrix::allocate(size_t count) const {
+        return static_cast<double*>(resource->allocate(std::max<size_t>(count, 1) * sizeof(double), MATRIX_ALIGNMENT));
     }
 
-    double& Matrix::get(const size_t& row, const size_t& col) {
-        if (row >= rows || col >= cols)
-            throw OutOfBoundsException();
-        return matrix[row][col];
+    void Matrix::deallocate(double* buffer, size_t count) const {
+        if (buffer && resource)
+            resource->deallocate(buffer, std::max<size_t>(count, 1) * sizeof(double), MATRIX_ALIGNMENT);
     }
 
-    const double& Matrix::get(const size_t& row, const size_t& col) const {
-        if (row >= rows || col >= cols)
-            throw OutOfBoundsException();
-        return matrix[row][col];
+    void Matrix::destroy() {
+        deallocate(matrix, capacity);
+        matrix = nullptr;
+        capacity = 0;
     }
 
-    void Matrix::set(const size_t& row, const size_t& col, const double& value) {
-        if (row >= rows || col >= cols)
-            throw OutOfBoundsException();
-        matrix[row][col] = value;
+    // Moves the visible elements into a rowsCapacity x colsCapacity buffer.
+    void Matrix::reallocate(size_t rowsCapacity, size_t colsCapacity) {
+        double* newMatrix = allocate(rowsCapacity * colsCapacity);
+        for (size_t i = 0; i < rows; ++i)
+            std::copy(matrix + i * stride, matrix + i * stride + cols, newMatrix + i * colsCapacity);
+        destroy();
+        matrix = newMatrix;
+        stride = colsCapacity;
+        capacity = rowsCapacity * colsCapacity;
     }
 
     void Matrix::resize(const size_t& newRows, const size_t& newCols) {
-        double** newMatrix = new double* [newRows];
-        for (size_t i = 0; i < newRows; ++i) {
-            newMatrix[i] = new double[newCols];
-            for (size_t j = 0; j < newCols; ++j) {
-                if (i < rows && j < cols)
-                    newMatrix[i][j] = matrix[i][j];
-                else
-                    newMatrix[i][j] = 0;
-            }
-        }
-        destroy();
+        const size_t rowsCapacity = getRowsCapacity();
+        if (newRows > rowsCapacity || newCols > stride)
+            reallocate(newRows > rowsCapacity ? std::max(newRows, 2 * rowsCapacity) : rowsCapacity,
+                       newCols > stride ? std::max(newCols, 2 * stride) : stride);
+        const size_t keptRows = std::min(rows, newRows);
+        if (newCols > cols)
+            for (size_t i = 0; i < keptRows; ++i)
+                std::fill(matrix + i * stride + cols, matrix + i * stride + newCols, 0.);
+        for (size_t i = keptRows; i < newRows; ++i)
+            std::fill(matrix + i * stride, matrix + i * stride + newCols, 0.);
         rows = newRows;
         cols = newCols;
-        matrix = newMatrix;
     }
 
-    Matrix::MatrixRow Matrix::operator[](const size_t& row) {
-        if (row >= rows)
-            throw OutOfBoundsException();
-        MatrixRow buffer(matrix[row], cols);
-        return buffer;
+    void Matrix::reserve(const size_t& rowsCapacity, const size_t& colsCapacity) {
+        if (rowsCapacity <= getRowsCapacity() && colsCapacity <= stride)
+            return;
+        reallocate(std::max(rowsCapacity, getRowsCapacity()), std::max(colsCapacity, stride));
     }
 
-    const Matrix::MatrixRow Matrix::operator[](const size_t& row) const {
-        if (row >= rows)
-            throw OutOfBoundsException();
-        MatrixRow buffer(matrix[row], cols);
-        return buffer;
+    void Matrix::shrinkToFit() {
+        if (stride != cols || capacity != rows * cols)
+            reallocate(rows, cols);
+    }
+
+    size_t Matrix::getRowsCapacity() const {
+        return stride == 0 ? rows : capacity / stride;
+    }
+
+    size_t Matrix::getColumnsCapacity() const {
+        return stride;
     }
 
     Matrix& Matrix::operator+=(const Matrix& add) {
         if (add.rows != rows || add.cols != cols)
             throw SizeMismatchException();
-        for (size_t i = 0; i < rows; ++i)
-            for (size_t j = 0; j < cols; ++j)
-                matrix[i][j] += add.matrix[i][j];
+        parallel::forRange(rows, cols, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                simd::add(matrix + i * stride, add.matrix + i * add.stride, matrix + i * stride, cols);
+        });
         return *this;
     }
 
     Matrix& Matrix::operator-=(const Matrix& diff) {
         if (diff.rows != rows || diff.cols != cols)
             throw SizeMismatchException();
-        for (size_t i = 0; i < rows; ++i)
-            for (size_t j = 0; j < cols; ++j)
-                matrix[i][j] -= diff.matrix[i][j];
+        parallel::forRange(rows, cols, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                simd::subtract(matrix + i * stride, diff.matrix + i * diff.stride, matrix + i * stride, cols);
+        });
         return *this;
     }
 
     Matrix& Matrix::operator*=(const Matrix& mult) {
         if (mult.rows != cols)
             throw SizeMismatchException();
-        Matrix buffer(rows, mult.cols);
-        for (size_t i = 0; i < buffer.rows; ++i)
-            for (size_t j = 0; j < buffer.cols; ++j) {
-                if (i == j)
-                    --buffer.matrix[i][j];
-                for (size_t k = 0; k < cols; ++k)
-                    buffer.matrix[i][j] += matrix[i][k] * mult.matrix[k][j];
-            }
-        *this = buffer;
-        return *this;
+        Matrix buffer(rows, mult.cols, resource);
+        multiplyInto(mult, buffer);
+        return *this = std::move(buffer);
     }
 
     Matrix& Matrix::operator*=(const double& number) {
-        for (size_t i = 0; i < rows; ++i)
-            for (size_t j = 0; j < cols; ++j)
-                matrix[i][j] *= number;
+        parallel::forRange(rows, cols, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                simd::scale(matrix + i * stride, number, matrix + i * stride, cols);
+        });
         return *this;
     }
 
@@ -175,9 +203,10 @@ namespace task {
         if (add.rows != rows || add.cols != cols)
             throw SizeMismatchException();
         Matrix buffer(rows, cols);
-        for (size_t i = 0; i < rows; ++i)
-            for (size_t j = 0; j < cols; ++j)
-                buffer.matrix[i][j] = matrix[i][j] + add.matrix[i][j];
+        parallel::forRange(rows, cols, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                simd::add(matrix + i * stride, add.matrix + i * add.stride, buffer.matrix + i * buffer.stride, cols);
+        });
         return buffer;
     }
 
@@ -185,9 +214,10 @@ namespace task {
         if (diff.rows != rows || diff.cols != cols)
             throw SizeMismatchException();
         Matrix buffer(rows, cols);
-        for (size_t i = 0; i < rows; ++i)
-            for (size_t j = 0; j < cols; ++j)
-                buffer.matrix[i][j] = matrix[i][j] - diff.matrix[i][j];
+        parallel::forRange(rows, cols, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                simd::subtract(matrix + i * stride, diff.matrix + i * diff.stride, buffer.matrix + i * buffer.stride, cols);
+        });
         return buffer;
     }
 
@@ -195,139 +225,148 @@ namespace task {
         if (mult.rows != cols)
             throw SizeMismatchException();
         Matrix buffer(rows, mult.cols);
-        for (size_t i = 0; i < rows; ++i)
-            for (size_t j = 0; j < mult.cols; ++j) {
-                if (i == j)
-                    --buffer.matrix[i][j];
-                for (size_t k = 0; k < cols; ++k)
-                    buffer.matrix[i][j] += matrix[i][k] * mult.matrix[k][j];
-            }
+        multiplyInto(mult, buffer);
         return buffer;
     }
 
+    void Matrix::multiplyInto(const Matrix& mult, Matrix& buffer) const {
+        const size_t cutoff = gemm::getStrassenCutoff();
+        if (rows > cutoff && rows == cols && cols == mult.cols) {
+            gemm::strassen(rows, matrix, stride, mult.matrix, mult.stride, buffer.matrix, buffer.stride);
+            return;
+        }
+        parallel::forRange(rows, mult.cols * cols, [&](size_t begin, size_t end) {
+            gemm::multiply(end - begin, mult.cols, cols, matrix + begin * stride, stride,
+                           mult.matrix, mult.stride, buffer.matrix + begin * buffer.stride, buffer.stride);
+        });
+    }
+
     Matrix Matrix::operator*(const double& number) const {
         Matrix buffer(rows, cols);
-        for (size_t i = 0; i < rows; ++i)
-            for (size_t j = 0; j < cols; ++j)
-                buffer.matrix[i][j] = matrix[i][j] * number;
+        parallel::forRange(rows, cols, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                simd::scale(matrix + i * stride, number, buffer.matrix + i * buffer.stride, cols);
+        });
         return buffer;
     }
 
     Matrix Matrix::operator-() const {
         Matrix buffer(rows, cols);
-        for (size_t i = 0; i < rows; ++i)
-            for (size_t j = 0; j < cols; ++j)
-                buffer.matrix[i][j] = -matrix[i][j];
+        parallel::forRange(rows, cols, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                simd::negate(matrix + i * stride, buffer.matrix + i * buffer.stride, cols);
+        });
         return buffer;
     }
 
     Matrix Matrix::operator+() const {
-        Matrix buffer(rows, cols);
-        for (size_t i = 0; i < rows; ++i)
-            for (size_t j = 0; j < cols; ++j)
-                buffer.matrix[i][j] = matrix[i][j];
-        return buffer;
+        return *this;
     }
 
     double Matrix::det() const {
         if (rows != cols || rows == 0)
             throw SizeMismatchException();
-        return det(rows, matrix);
-    }
-
-    double Matrix::det(const size_t& size, double** matrixPart) const {
-        if (size == 1)
-            return matrixPart[0][0];
-        double result = 0;
-        for (size_t i = 0; i < size; ++i) {
-            double** newMatrix = new double* [size - 1];
-            for (size_t j = 0; j < size - 1; ++j) {
-                newMatrix[j] = new double[size - 1];
-                for (size_t k = 0; k < size - 1; ++k) {
-                    if (j < i)
-                        newMatrix[j][k] = matrixPart[j][k + 1];
-                    else
-                        newMatrix[j][k] = matrixPart[j + 1][k + 1];
-                }
-            }
-            double add = matrixPart[i][0] * det(size - 1, newMatrix);
-            result += (i % 2 == 0 ? add : -add);
-            for (size_t j = 0; j < size - 1; ++j)
-                delete[] newMatrix[j];
-            delete[] newMatrix;
-        }
-        return result;
+        if (rows <= BAREISS_DET_SIZE)
+            return bareissDet();
+        return LUDecomposition(*this).det();
+    }
+
+    LUDecomposition Matrix::lu() const {
+        return LUDecomposition(*this);
+    }
+
+    CholeskyDecomposition Matrix::cholesky() const {
+        return CholeskyDecomposition(*this);
+    }
+
+    QRDecomposition Matrix::qr() const {
+        return QRDecomposition(*this);
+    }
+
+    Matrix Matrix::solve(const Matrix& rhs) const {
+        return LUDecomposition(*this).solve(rhs);
+    }
+
+    Matrix Matrix::inverse() const {
+        return LUDecomposition(*this).solve(Matrix(rows, cols));
+    }
+
+    size_t Matrix::rank() const {
+        return QRDecomposition(*this).getRank();
+    }
+
+    double Matrix::bareissDet() const {
+        if (rows != cols || rows == 0)
+            throw SizeMismatchException();
+        Matrix buffer(*this);
+        return strided::bareissDet(buffer.matrix, buffer.stride, rows);
     }
 
     void Matrix::transpose() {
         if (rows == cols) {
-            for (size_t i = 1; i < rows; ++i)
-                for (size_t j = 0; j <= i; ++j)
-                    std::swap(matrix[i][j], matrix[j][i]);
-        }
-        else {
-            double** buffer = new double* [cols];
-            for (size_t i = 0; i < cols; ++i) {
-                buffer[i] = new double[rows];
-                for (size_t j = 0; j < rows; ++j)
-                    buffer[i][j] = matrix[j][i];
-            }
-            destroy();
-            std::swap(rows, cols);
-            matrix = buffer;
+            simd::transposeSquare(matrix, stride, rows);
+            return;
         }
+        Matrix result(cols, rows, resource);
+        transposeInto(result);
+        *this = std::move(result);
     }
 
     Matrix Matrix::transposed() const {
-        double** buffer = new double* [cols];
-        for (size_t i = 0; i < cols; ++i) {
-            buffer[i] = new double[rows];
-            for (size_t j = 0; j < rows; ++j)
-                buffer[i][j] = matrix[j][i];
-        }
-        Matrix result;
-        result.rows = cols;
-        result.cols = rows;
-        result.matrix = buffer;
+        Matrix result(cols, rows);
+        transposeInto(result);
         return result;
     }
 
+    void Matrix::transposeInto(Matrix& result) const {
+        parallel::forRange(cols, rows, [&](size_t begin, size_t end) {
+            simd::transpose(matrix + begin, stride, result.matrix + begin * result.stride, result.stride, rows, end - begin);
+        });
+    }
+
     double Matrix::trace() const {
         if (rows != cols || rows == 0)
             throw SizeMismatchException();
-        double result = 0;
-        for (size_t i = 0; i < cols; ++i)
-            for (size_t j = 0; j < rows; ++j)
-                if (i == j)
-                    result += matrix[j][i];
-        return result;
+        return strided::trace(matrix, stride, rows);
     }
 
     std::vector<double> Matrix::getRow(const size_t& row) {
-        std::vector<double> arr;
         if (row >= rows)
             throw OutOfBoundsException();
-        for (size_t i = 0; i < cols; ++i)
-            arr.push_back(matrix[row][i]);
-        return arr;
+        return std::vector<double>(matrix + row * stride, matrix + row * stride + cols);
     }
 
     std::vector<double> Matrix::getColumn(const size_t& col) {
-        std::vector<double> arr;
         if (col >= cols)
             throw OutOfBoundsException();
-        for (size_t i = 0; i < cols; ++i)
-            arr.push_back(matrix[i][col]);
-        return arr;
+        return strided::column(matrix, stride, rows, col);
+    }
+
+    RowView Matrix::getRowView(const size_t& row) const {
+        if (row >= rows)
+            throw OutOfBoundsException();
+        return RowView(matrix + row * stride, cols);
+    }
+
+    ColumnView Matrix::getColumnView(const size_t& col) const {
+        if (col >= cols)
+            throw OutOfBoundsException();
+        return ColumnView(matrix + col, rows, stride);
+    }
+
+    SubMatrixView Matrix::getSubMatrixView(const size_t& row, const size_t& col,
+                                           const size_t& viewRows, const size_t& viewCols) const {
+        if (row > rows || col > cols || viewRows > rows - row || viewCols > cols - col)
+            throw OutOfBoundsException();
+        return SubMatrixView(matrix + row * stride + col, viewRows, viewCols, stride);
     }
 
     bool Matrix::operator==(const Matrix& comp) const {
         if (rows != comp.rows || cols != comp.cols)
             return false;
         for (size_t i = 0; i < rows; ++i)
-            for (size_t j = 0; j < cols; ++j)
-                if (abs(matrix[i][j] - comp.matrix[i][j]) > EPS)
-                    return false;
+            if (!simd::equal(matrix + i * stride, comp.matrix + i * comp.stride, cols, EPS))
+                return false;
         return true;
     }
 
@@ -339,23 +378,78 @@ namespace task {
         return mult * number;
     }
 
+    MatrixReference::MatrixReference(const Matrix& source)
+        : data(source.matrix), rows(source.rows), cols(source.cols), stride(source.stride) {}
+
+    MatrixReference lazy(const Matrix& source) {
+        return MatrixReference(source);
+    }
+
     std::ostream& operator<<(std::ostream& out, const Matrix& matrix) {
-        for (size_t i = 0; i < matrix.getRowsCount(); ++i) {
-            for (size_t j = 0; j < matrix.getColumnsCount(); ++j)
-                out << matrix[i][j] << ' ';
-            out << '\n';
+        return strided::write(out, matrix.getData(), matrix.getStride(), matrix.getRowsCount(), matrix.getColumnsCount());
+    }
+
+    namespace {
+
+        int inputFormatIndex() {
+            static const int index = std::ios_base::xalloc();
+            return index;
+        }
+
+        // Up to this many triplets are reserved from the header's count before any is read.
+        const size_t COO_RESERVE_LIMIT = size_t(1) << 16;
+
+        std::istream& readCoordinates(std::istream& in, Matrix& matrix) {
+            size_t rows, cols;
+            std::vector<Triplet> entries;
+            if (!readCoordinates(in, rows, cols, entries))
+                return in;
+            for (const Triplet& entry : entries)
+                if (entry.row >= rows || entry.col >= cols)
+                    throw OutOfBoundsException();
+            matrix.resize(rows, cols);
+            for (size_t i = 0; i < rows && cols > 0; ++i)
+                std::fill(&matrix.get(i, 0), &matrix.get(i, 0) + cols, 0.);
+            for (const Triplet& entry : entries)
+                matrix.uncheckedAt(entry.row, entry.col) += entry.value;
+            return in;
+        }
+
+    }  // namespace
+
+    bool readCoordinates(std::istream& in, size_t& rows, size_t& cols, std::vector<Triplet>& entries) {
+        size_t count;
+        if (!(in >> rows >> cols >> count))
+            return false;
+        entries.clear();
+        entries.reserve(std::min(count, COO_RESERVE_LIMIT));
+        for (size_t k = 0; k < count; ++k) {
+            Triplet entry;
+            if (!(in >> entry.row >> entry.col >> entry.value))
+                return false;
+            entries.push_back(entry);
         }
-        return out;
+        return true;
+    }
+
+    std::ios_base& dense(std::ios_base& stream) {
+        stream.iword(inputFormatIndex()) = 0;
+        return stream;
+    }
+
+    std::ios_base& coo(std::ios_base& stream) {
+        stream.iword(inputFormatIndex()) = 1;
+        return stream;
+    }
+
+    bool isCooInput(std::ios_base& stream) {
+        return stream.iword(inputFormatIndex()) == 1;
     }
 
     std::istream& operator>>(std::istream& in, Matrix& matrix) {
-        size_t rows, cols;
-        in >> rows >> cols;
-        matrix.resize(rows, cols);
-        for (size_t i = 0; i < matrix.getRowsCount(); ++i)
-            for (size_t j = 0; j < matrix.getColumnsCount(); ++j)
-                in >> matrix[i][j];
-        return in;
+        if (isCooInput(in))
+            return readCoordinates(in, matrix);
+        return strided::read(in, matrix);
     }
 
-}   // namespace std
\ No newline at end of file
+}   // namespace std
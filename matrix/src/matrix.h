@@ -1,16 +1,65 @@
 #pragma once
 
+#include <cassert>
 #include <vector>
 #include <iostream>
+#include "strided.h"
+#include "expression.h"
+#include "matrix_memory.h"
+#include "view.h"
 
 namespace task {
 
-    const double EPS = 1e-6;
+    constexpr double EPS = 1e-6;
 
     class OutOfBoundsException : public std::exception {};
     class SizeMismatchException : public std::exception {};
+    class SingularMatrixException : public std::exception {};
+    class NotPositiveDefiniteException : public std::exception {};
 
-    class Matrix {
+    // Bounds-check policy of the element accessors. They throw OutOfBoundsException by default;
+    // building with TASK_MATRIX_UNCHECKED turns the checks into asserts, which NDEBUG removes.
+    // The policy is baked into inline definitions, so it is a whole-program choice: every TU
+    // that includes this header references the library's symbol for its own mode, and a TU
+    // built in the other mode fails to link instead of silently breaking the ODR.
+    namespace access {
+
+#ifdef TASK_MATRIX_UNCHECKED
+        constexpr bool CHECKED = false;
+        bool uncheckedBuild();
+#else
+        constexpr bool CHECKED = true;
+        bool checkedBuild();
+#endif
+
+        inline void check(bool inside) {
+            if constexpr (CHECKED) {
+                if (!inside)
+                    throw OutOfBoundsException();
+            } else {
+                assert(inside);
+            }
+        }
+
+        namespace {
+#ifdef TASK_MATRIX_UNCHECKED
+            [[maybe_unused]] const bool modeLinked = uncheckedBuild();
+#else
+            [[maybe_unused]] const bool modeLinked = checkedBuild();
+#endif
+        }  // namespace
+
+    }  // namespace access
+
+    // Up to this size det() uses fraction-free Bareiss elimination instead of LU.
+    const size_t BAREISS_DET_SIZE = 4;
+
+    class LUDecomposition;
+    class CholeskyDecomposition;
+    class QRDecomposition;
+
+    template<>
+    class BasicMatrix<double> {
     private:
 
         class MatrixRow {
@@ -26,22 +75,61 @@ namespace task {
 
         };
 
-        double** matrix;
-        size_t rows, cols;
+        std::pmr::memory_resource* resource;
+        double* matrix;
+        size_t rows, cols, stride;
+        size_t capacity;
+
+        friend class LUDecomposition;
+        friend class CholeskyDecomposition;
+        friend class QRDecomposition;
+        friend class MatrixReference;
+        friend class MappedMatrix;
 
+        // Wraps rows x cols doubles owned by someone else (the mapping of a MappedMatrix)
+        // without copying them. resource stays null and destroy() leaves the buffer alone; such
+        // matrices are only handed out as const, so the buffer is never written or reallocated.
+        struct Borrowed {};
+        BasicMatrix(Borrowed, const double*, size_t, size_t);
+
+        double* allocate(size_t) const;
+        void deallocate(double*, size_t) const;
         void destroy();
-        double abs(const double&) const;
-        double det(const size_t&, double**) const;
+        void reallocate(size_t, size_t);
+
+        template<class E>
+        void evaluate(const MatrixExpression<E>&);
+
+        // Fill a result of the right size that the caller allocated, so that the in-place
+        // versions can take it from the target's resource.
+        void multiplyInto(const Matrix&, Matrix&) const;
+        void transposeInto(Matrix&) const;
 
     public:
 
-        Matrix();
-        explicit Matrix(const size_t&, const size_t&);
-        Matrix(const Matrix&);
+        // Storage comes from `resource`, or from getDefaultMatrixResource() when it is null.
+        // Copies take the default resource and moves (assignment included) carry the source's
+        // resource along with its buffer; resize and every other assignment keep the target's.
+        // getResource() is null for the borrowed storage of MappedMatrix::getMatrix().
+        BasicMatrix();
+        explicit BasicMatrix(const size_t&, const size_t&, std::pmr::memory_resource* resource = nullptr);
+        // All zeros, unlike the identity-like (rows, cols) constructor.
+        static Matrix zeros(const size_t&, const size_t&, std::pmr::memory_resource* resource = nullptr);
+        BasicMatrix(const Matrix&);
+        BasicMatrix(const Matrix&, std::pmr::memory_resource*);
+        BasicMatrix(Matrix&&) noexcept;
+        template<class E>
+        BasicMatrix(const MatrixExpression<E>&);
+        // Element-wise conversion from a BasicMatrix of another arithmetic type.
+        template<class U>
+        explicit BasicMatrix(const BasicMatrix<U>&);
 
-        ~Matrix();
+        ~BasicMatrix();
 
         Matrix& operator=(const Matrix&);
+        Matrix& operator=(Matrix&&) noexcept;
+        template<class E>
+        Matrix& operator=(const MatrixExpression<E>&);
 
         size_t getRowsCount() const;
         size_t getColumnsCount() const;
@@ -49,13 +137,33 @@ namespace task {
         double& get(const size_t&, const size_t&);
         const double& get(const size_t&, const size_t&) const;
         void set(const size_t&, const size_t&, const double&);
+
+        // Never checked, in any build. Row i starts at getData() + i * getStride().
+        double& uncheckedAt(const size_t& row, const size_t& col) { return matrix[row * stride + col]; }
+        const double& uncheckedAt(const size_t& row, const size_t& col) const { return matrix[row * stride + col]; }
+        double* getData() { return matrix; }
+        const double* getData() const { return matrix; }
+        size_t getStride() const { return stride; }
+        std::pmr::memory_resource* getResource() const { return resource; }
         void resize(const size_t&, const size_t&);
 
+        // Capacity works like std::vector's: shrinking or growing within it never reallocates,
+        // and growing past it at least doubles the capacity of the dimension that overflowed.
+        // The columns capacity is the row stride.
+        void reserve(const size_t&, const size_t&);
+        void shrinkToFit();
+        size_t getRowsCapacity() const;
+        size_t getColumnsCapacity() const;
+
         MatrixRow operator[](const size_t&);
         const MatrixRow operator[](const size_t&) const;
 
         Matrix& operator+=(const Matrix&);
         Matrix& operator-=(const Matrix&);
+        template<class E>
+        Matrix& operator+=(const MatrixExpression<E>&);
+        template<class E>
+        Matrix& operator-=(const MatrixExpression<E>&);
         Matrix& operator*=(const Matrix&);
         Matrix& operator*=(const double&);
 
@@ -68,6 +176,16 @@ namespace task {
         Matrix operator+() const;
 
         double det() const;
+        // Fraction-free elimination: exact for integer matrices whose minors fit in a double.
+        double bareissDet() const;
+        LUDecomposition lu() const;
+        CholeskyDecomposition cholesky() const;
+        QRDecomposition qr() const;
+        // X with this * X = rhs for a square nonsingular matrix, one column per right-hand side.
+        Matrix solve(const Matrix&) const;
+        Matrix inverse() const;
+        // Numerical rank: diagonal entries of the column-pivoted R above EPS * |R(0, 0)|.
+        size_t rank() const;
         void transpose();
         Matrix transposed() const;
         double trace() const;
@@ -75,6 +193,10 @@ namespace task {
         std::vector<double> getRow(const size_t&);
         std::vector<double> getColumn(const size_t&);
 
+        RowView getRowView(const size_t&) const;
+        ColumnView getColumnView(const size_t&) const;
+        SubMatrixView getSubMatrixView(const size_t&, const size_t&, const size_t&, const size_t&) const;
+
         bool operator==(const Matrix&) const;
         bool operator!=(const Matrix&) const;
 
@@ -82,7 +204,139 @@ namespace task {
 
     Matrix operator*(const double&, const Matrix&);
 
+    // Element access is inline so that loops over get() and [][] compile down to plain
+    // pointer arithmetic and the MatrixRow proxy disappears.
+
+    inline size_t Matrix::getRowsCount() const {
+        return rows;
+    }
+
+    inline size_t Matrix::getColumnsCount() const {
+        return cols;
+    }
+
+    inline Matrix::MatrixRow::MatrixRow(double* row, const size_t& cols) : row(row), cols(cols) {}
+
+    inline double& Matrix::MatrixRow::operator[](const size_t& col) {
+        access::check(col < cols);
+        return row[col];
+    }
+
+    inline const double& Matrix::MatrixRow::operator[](const size_t& col) const {
+        access::check(col < cols);
+        return row[col];
+    }
+
+    inline double& Matrix::get(const size_t& row, const size_t& col) {
+        access::check(row < rows && col < cols);
+        return matrix[row * stride + col];
+    }
+
+    inline const double& Matrix::get(const size_t& row, const size_t& col) const {
+        access::check(row < rows && col < cols);
+        return matrix[row * stride + col];
+    }
+
+    inline void Matrix::set(const size_t& row, const size_t& col, const double& value) {
+        access::check(row < rows && col < cols);
+        matrix[row * stride + col] = value;
+    }
+
+    inline Matrix::MatrixRow Matrix::operator[](const size_t& row) {
+        access::check(row < rows);
+        return MatrixRow(matrix + row * stride, cols);
+    }
+
+    inline const Matrix::MatrixRow Matrix::operator[](const size_t& row) const {
+        access::check(row < rows);
+        return MatrixRow(matrix + row * stride, cols);
+    }
+
+    // PA = LU with partial pivoting; L is unit lower triangular and shares storage with U.
+    class LUDecomposition {
+    private:
+        Matrix lu;
+        std::vector<size_t> permutation;
+        bool swapsOdd;
+        bool singular;
+
+    public:
+
+        explicit LUDecomposition(const Matrix&);
+
+        const Matrix& getLU() const;
+        const std::vector<size_t>& getPermutation() const;
+        bool isSingular() const;
+
+        double det() const;
+        Matrix solve(const Matrix&) const;
+
+    };
+
+    // A = L L^T for a symmetric positive definite A, with L lower triangular; only the lower
+    // triangle of A is read. Throws NotPositiveDefiniteException when a pivot is not positive.
+    class CholeskyDecomposition {
+    private:
+        Matrix l;
+
+    public:
+
+        explicit CholeskyDecomposition(const Matrix&);
+
+        const Matrix& getL() const;
+
+        double det() const;
+        Matrix solve(const Matrix&) const;
+
+    };
+
+    // AP = QR by Householder reflections with column pivoting, for any shape. The reflectors are
+    // kept below the diagonal of R, and Q is only formed on request.
+    class QRDecomposition {
+    private:
+        Matrix qr;
+        std::vector<double> tau;
+        std::vector<size_t> permutation;
+        size_t rank;
+
+    public:
+
+        explicit QRDecomposition(const Matrix&);
+
+        Matrix getQ() const;
+        Matrix getR() const;
+        const std::vector<size_t>& getPermutation() const;
+        size_t getRank() const;
+
+        // Least-squares solution minimizing |A X - rhs| per column; for rank-deficient A it is the
+        // basic solution with zeros in the dependent columns.
+        Matrix solve(const Matrix&) const;
+
+    };
+
     std::ostream& operator<<(std::ostream&, const Matrix&);
     std::istream& operator>>(std::istream&, Matrix&);
 
+    // Text input formats, sticky like std::hex. `dense` (the default) reads the size and then
+    // every value; `coo` reads "rows cols count" and then `count` zero-based "row col value"
+    // triplets, summing duplicates and leaving every other element zero.
+    std::ios_base& dense(std::ios_base&);
+    std::ios_base& coo(std::ios_base&);
+    bool isCooInput(std::ios_base&);
+
+    // One coordinate-format (COO) entry: `value` at (row, col), zero-based.
+    struct Triplet {
+        size_t row, col;
+        double value;
+    };
+
+    // Reads the "rows cols count" header and `count` triplets of the COO format, shared by
+    // Matrix, CsrMatrix and CscMatrix. The header is untrusted: storage grows with the
+    // triplets actually read, not with `count`. Indices are not checked against the size.
+    bool readCoordinates(std::istream&, size_t&, size_t&, std::vector<Triplet>&);
+
 }  // namespace task
+
+
+#include "matrix.tpp"
+#include "basic_matrix.h"
@@ -0,0 +1,123 @@
+#include "matrix.h"
+#include <utility>
+
+namespace task {
+
+    template<class L, class R>
+    MatrixSum<L, R>::MatrixSum(const L& left, const R& right) : left(left), right(right) {
+        if (left.getRowsCount() != right.getRowsCount() || left.getColumnsCount() != right.getColumnsCount())
+            throw SizeMismatchException();
+    }
+
+    template<class L, class R>
+    MatrixDifference<L, R>::MatrixDifference(const L& left, const R& right) : left(left), right(right) {
+        if (left.getRowsCount() != right.getRowsCount() || left.getColumnsCount() != right.getColumnsCount())
+            throw SizeMismatchException();
+    }
+
+    template<class L, class R>
+    MatrixSum<L, R> operator+(const MatrixExpression<L>& left, const MatrixExpression<R>& right) {
+        return MatrixSum<L, R>(left.self(), right.self());
+    }
+
+    template<class L>
+    MatrixSum<L, MatrixReference> operator+(const MatrixExpression<L>& left, const Matrix& right) {
+        return MatrixSum<L, MatrixReference>(left.self(), MatrixReference(right));
+    }
+
+    template<class R>
+    MatrixSum<MatrixReference, R> operator+(const Matrix& left, const MatrixExpression<R>& right) {
+        return MatrixSum<MatrixReference, R>(MatrixReference(left), right.self());
+    }
+
+    template<class L, class R>
+    MatrixDifference<L, R> operator-(const MatrixExpression<L>& left, const MatrixExpression<R>& right) {
+        return MatrixDifference<L, R>(left.self(), right.self());
+    }
+
+    template<class L>
+    MatrixDifference<L, MatrixReference> operator-(const MatrixExpression<L>& left, const Matrix& right) {
+        return MatrixDifference<L, MatrixReference>(left.self(), MatrixReference(right));
+    }
+
+    template<class R>
+    MatrixDifference<MatrixReference, R> operator-(const Matrix& left, const MatrixExpression<R>& right) {
+        return MatrixDifference<MatrixReference, R>(MatrixReference(left), right.self());
+    }
+
+    template<class E>
+    MatrixScaled<E> operator*(const MatrixExpression<E>& operand, const double& number) {
+        return MatrixScaled<E>(operand.self(), number);
+    }
+
+    template<class E>
+    MatrixScaled<E> operator*(const double& number, const MatrixExpression<E>& operand) {
+        return MatrixScaled<E>(operand.self(), number);
+    }
+
+    template<class E>
+    MatrixNegation<E> operator-(const MatrixExpression<E>& operand) {
+        return MatrixNegation<E>(operand.self());
+    }
+
+    template<class E>
+    const E& operator+(const MatrixExpression<E>& operand) {
+        return operand.self();
+    }
+
+    template<class E>
+    void Matrix::evaluate(const MatrixExpression<E>& expression) {
+        const E& source = expression.self();
+        for (size_t i = 0; i < rows; ++i) {
+            double* row = matrix + i * stride;
+            for (size_t j = 0; j < cols; ++j)
+                row[j] = source(i, j);
+        }
+    }
+
+    template<class E>
+    Matrix::BasicMatrix(const MatrixExpression<E>& expression)
+        : resource(getDefaultMatrixResource()),
+          matrix(allocate(expression.getRowsCount() * expression.getColumnsCount())),
+          rows(expression.getRowsCount()), cols(expression.getColumnsCount()), stride(cols), capacity(rows * cols) {
+        evaluate(expression);
+    }
+
+    template<class E>
+    Matrix& Matrix::operator=(const MatrixExpression<E>& expression) {
+        if (expression.getRowsCount() == rows && expression.getColumnsCount() == cols) {
+            evaluate(expression);
+            return *this;
+        }
+        Matrix result(expression.getRowsCount(), expression.getColumnsCount(), resource);
+        result.evaluate(expression);
+        return *this = std::move(result);
+    }
+
+    template<class E>
+    Matrix& Matrix::operator+=(const MatrixExpression<E>& expression) {
+        if (expression.getRowsCount() != rows || expression.getColumnsCount() != cols)
+            throw SizeMismatchException();
+        const E& source = expression.self();
+        for (size_t i = 0; i < rows; ++i) {
+            double* row = matrix + i * stride;
+            for (size_t j = 0; j < cols; ++j)
+                row[j] += source(i, j);
+        }
+        return *this;
+    }
+
+    template<class E>
+    Matrix& Matrix::operator-=(const MatrixExpression<E>& expression) {
+        if (expression.getRowsCount() != rows || expression.getColumnsCount() != cols)
+            throw SizeMismatchException();
+        const E& source = expression.self();
+        for (size_t i = 0; i < rows; ++i) {
+            double* row = matrix + i * stride;
+            for (size_t j = 0; j < cols; ++j)
+                row[j] -= source(i, j);
+        }
+        return *this;
+    }
+
+}  // namespace task
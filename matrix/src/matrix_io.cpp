@@ -0,0 +1,532 @@
+#include "matrix_io.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace task {
+
+    namespace {
+
+        const char MAGIC[4] = {'T', 'M', 'A', 'T'};
+        const uint8_t VERSION = 1;
+        const uint8_t DTYPE_DOUBLE = 1;
+        const uint8_t LITTLE_ENDIAN_ORDER = 1;
+        const uint8_t BIG_ENDIAN_ORDER = 2;
+        const size_t HEADER_SIZE = 64;
+
+        struct Header {
+            size_t rows, cols;
+            size_t offset;
+            bool swapBytes;
+        };
+
+        bool nativeLittleEndian() {
+            const uint16_t probe = 1;
+            unsigned char first;
+            std::memcpy(&first, &probe, 1);
+            return first == 1;
+        }
+
+        template<class T>
+        T swapped(T value) {
+            unsigned char bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            std::reverse(bytes, bytes + sizeof(T));
+            std::memcpy(&value, bytes, sizeof(T));
+            return value;
+        }
+
+        template<class T>
+        T load(const unsigned char* buffer, bool swapBytes) {
+            T value;
+            std::memcpy(&value, buffer, sizeof(T));
+            return swapBytes ? swapped(value) : value;
+        }
+
+        void encodeHeader(unsigned char* buffer, size_t rows, size_t cols) {
+            std::memset(buffer, 0, HEADER_SIZE);
+            std::memcpy(buffer, MAGIC, sizeof(MAGIC));
+            buffer[4] = VERSION;
+            buffer[5] = DTYPE_DOUBLE;
+            buffer[6] = nativeLittleEndian() ? LITTLE_ENDIAN_ORDER : BIG_ENDIAN_ORDER;
+            const uint32_t alignment = BINARY_ALIGNMENT;
+            const uint32_t offset = std::max(HEADER_SIZE, BINARY_ALIGNMENT);
+            const uint64_t rowsCount = rows, colsCount = cols;
+            std::memcpy(buffer + 8, &alignment, sizeof(alignment));
+            std::memcpy(buffer + 12, &offset, sizeof(offset));
+            std::memcpy(buffer + 16, &rowsCount, sizeof(rowsCount));
+            std::memcpy(buffer + 24, &colsCount, sizeof(colsCount));
+        }
+
+        Header decodeHeader(const unsigned char* buffer) {
+            if (std::memcmp(buffer, MAGIC, sizeof(MAGIC)) != 0 || buffer[4] != VERSION || buffer[5] != DTYPE_DOUBLE)
+                throw MatrixFormatException();
+            if (buffer[6] != LITTLE_ENDIAN_ORDER && buffer[6] != BIG_ENDIAN_ORDER)
+                throw MatrixFormatException();
+            Header header;
+            header.swapBytes = (buffer[6] == LITTLE_ENDIAN_ORDER) != nativeLittleEndian();
+            header.offset = load<uint32_t>(buffer + 12, header.swapBytes);
+            header.rows = load<uint64_t>(buffer + 16, header.swapBytes);
+            header.cols = load<uint64_t>(buffer + 24, header.swapBytes);
+            if (header.offset < HEADER_SIZE)
+                throw MatrixFormatException();
+            if (header.cols != 0 && header.rows > SIZE_MAX / sizeof(double) / header.cols)
+                throw MatrixFormatException();
+            return header;
+        }
+
+        void writePadding(std::ostream& out, size_t count) {
+            const char zeros[BINARY_ALIGNMENT] = {};
+            while (count > 0) {
+                size_t chunk = std::min(count, sizeof(zeros));
+                out.write(zeros, chunk);
+                count -= chunk;
+            }
+        }
+
+        // readBinary and readText grow their result in blocks of this many bytes when the
+        // stream cannot tell how much it holds.
+        const size_t UNKNOWN_SIZE_BLOCK = 1 << 24;
+
+        // Texts shorter than this are parsed in one pass on the calling thread.
+        const size_t PARALLEL_TEXT_SIZE = 1 << 20;
+
+        // readText and writeText keep at most about this much text in memory at a time.
+        const size_t TEXT_BATCH_SIZE = 4 * PARALLEL_TEXT_SIZE;
+
+        // Stores the number of bytes between the read position and the end of the stream, if
+        // the stream can seek; otherwise clears the failed seek and returns false.
+        bool remainingBytes(std::istream& in, size_t& remaining) {
+            const std::streampos position = in.tellg();
+            if (position == std::streampos(-1) || !in.seekg(0, std::ios::end)) {
+                in.clear();
+                return false;
+            }
+            const std::streamoff length = in.tellg() - position;
+            in.seekg(position);
+            remaining = length < 0 ? 0 : static_cast<size_t>(length);
+            return true;
+        }
+
+        // rows * cols, refusing sizes whose storage could not even be addressed.
+        size_t elementsCount(size_t rows, size_t cols) {
+            if (cols != 0 && rows > SIZE_MAX / sizeof(double) / cols)
+                throw MatrixFormatException();
+            return rows * cols;
+        }
+
+        // Longest output of std::to_chars for a double, plus the separator.
+        const size_t FORMATTED_DOUBLE_SIZE = 32;
+
+        bool isSpace(char symbol) {
+            return symbol == ' ' || symbol == '\n' || symbol == '\t' || symbol == '\r' || symbol == '\v' || symbol == '\f';
+        }
+
+        const char* skipSpaces(const char* first, const char* last) {
+            while (first != last && isSpace(*first))
+                ++first;
+            return first;
+        }
+
+        // Parses one token starting at `first` and returns its end. A leading '+' is accepted
+        // as istream extraction does, and the token has to end at whitespace or `last`.
+        template<class T>
+        const char* parseToken(const char* first, const char* last, T& value) {
+            if (last - first > 1 && *first == '+' && first[1] != '-')
+                ++first;
+            auto result = std::from_chars(first, last, value);
+            if (result.ec != std::errc() || (result.ptr != last && !isSpace(*result.ptr)))
+                throw MatrixFormatException();
+            return result.ptr;
+        }
+
+        size_t countTokens(const char* first, const char* last) {
+            size_t count = 0;
+            bool inToken = false;
+            for (; first != last; ++first) {
+                const bool space = isSpace(*first);
+                count += !space && !inToken;
+                inToken = !space;
+            }
+            return count;
+        }
+
+        // Reads up to `count` values into the elements of `matrix` starting at index `index`
+        // (row-major) and returns the end of the last one parsed.
+        const char* parseValues(const char* first, const char* last, Matrix& matrix, size_t index, size_t count) {
+            const size_t cols = matrix.getColumnsCount();
+            double* data = matrix.getData();
+            const size_t stride = matrix.getStride();
+            size_t row = index / cols, col = index % cols;
+            for (size_t k = 0; k < count; ++k) {
+                first = skipSpaces(first, last);
+                if (first == last)
+                    throw MatrixFormatException();
+                first = parseToken(first, last, data[row * stride + col]);
+                if (++col == cols) {
+                    col = 0;
+                    ++row;
+                }
+            }
+            return first;
+        }
+
+        // Splits [first, last) into `chunks` pieces that end at whitespace, so no token straddles
+        // two of them, counts the tokens of every piece and then parses them all concurrently,
+        // starting at element `index`. `count` is the most values to parse; it is lowered to the
+        // number of tokens when there are fewer.
+        const char* parseValuesInChunks(const char* first, const char* last, Matrix& matrix, size_t index, size_t& count) {
+            const size_t chunks = parallel::getThreadsCount() * 4;
+            const size_t length = last - first;
+            std::vector<const char*> bounds(chunks + 1, last);
+            bounds[0] = first;
+            for (size_t i = 1; i < chunks; ++i) {
+                const char* bound = std::max(bounds[i - 1], first + length / chunks * i);
+                while (bound != last && !isSpace(*bound))
+                    ++bound;
+                bounds[i] = bound;
+            }
+            std::vector<size_t> offsets(chunks + 1, 0);
+            parallel::forRange(chunks, length / chunks, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i)
+                    offsets[i + 1] = countTokens(bounds[i], bounds[i + 1]);
+            });
+            for (size_t i = 0; i < chunks; ++i)
+                offsets[i + 1] += offsets[i];
+            const size_t total = count = std::min(count, offsets[chunks]);
+            if (total == 0)
+                return first;
+            const size_t lastChunk = std::upper_bound(offsets.begin(), offsets.end(), total - 1) - offsets.begin() - 1;
+            const char* stop = last;
+            parallel::forRange(lastChunk + 1, length / chunks, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const size_t count = std::min(total, offsets[i + 1]) - offsets[i];
+                    const char* chunkStop = parseValues(bounds[i], bounds[i + 1], matrix, index + offsets[i], count);
+                    if (i == lastChunk)
+                        stop = chunkStop;
+                }
+            });
+            return stop;
+        }
+
+        // Parses up to `count` values of [first, last) into `matrix` from element `index` on,
+        // in chunks on the thread pool when the text is long enough, and lowers `count` to the
+        // number of values parsed.
+        const char* parseAvailable(const char* first, const char* last, Matrix& matrix, size_t index, size_t& count) {
+            if (last - first >= static_cast<ptrdiff_t>(PARALLEL_TEXT_SIZE) && parallel::getThreadsCount() > 1)
+                return parseValuesInChunks(first, last, matrix, index, count);
+            count = std::min(count, countTokens(first, last));
+            return parseValues(first, last, matrix, index, count);
+        }
+
+        // Reads a stream in TEXT_BATCH_SIZE batches into one reused buffer. The window
+        // [first(), last()) is the text read but not consumed yet, cut after its last whitespace
+        // so that no token is split between two batches; once the stream is exhausted the
+        // window runs to the end of the text.
+        class TextBatches {
+        private:
+            std::streambuf& source;
+            std::string buffer;
+            size_t begin, end;
+            bool exhausted;
+
+        public:
+            explicit TextBatches(std::streambuf& source) : source(source), begin(0), end(0), exhausted(false) {}
+
+            const char* first() const { return buffer.data() + begin; }
+            const char* last() const { return buffer.data() + end; }
+            size_t getBufferedBytes() const { return buffer.size() - begin; }
+
+            void consume(const char* position) { begin = position - buffer.data(); }
+
+            // Drops the consumed text and appends the next batch; false once nothing is left.
+            bool next() {
+                if (exhausted)
+                    return false;
+                buffer.erase(0, begin);
+                begin = 0;
+                const size_t kept = buffer.size();
+                buffer.resize(kept + TEXT_BATCH_SIZE);
+                const std::streamsize read = source.sgetn(buffer.data() + kept, TEXT_BATCH_SIZE);
+                buffer.resize(kept + static_cast<size_t>(std::max<std::streamsize>(read, 0)));
+                exhausted = read < static_cast<std::streamsize>(TEXT_BATCH_SIZE);
+                end = buffer.size();
+                while (!exhausted && end != 0 && !isSpace(buffer[end - 1]))
+                    --end;
+                return true;
+            }
+
+            // Parses the next token, reading batches until one is complete.
+            template<class T>
+            void parse(T& value) {
+                const char* position = skipSpaces(first(), last());
+                while (position == last() && next())
+                    position = skipSpaces(first(), last());
+                if (position == last())
+                    throw MatrixFormatException();
+                consume(parseToken(position, last(), value));
+            }
+        };
+
+        char* formatRow(char* out, const double* row, size_t cols) {
+            for (size_t j = 0; j < cols; ++j) {
+                out = std::to_chars(out, out + FORMATTED_DOUBLE_SIZE, row[j]).ptr;
+                *out++ = ' ';
+            }
+            return out;
+        }
+
+    }  // namespace
+
+    Matrix parseText(std::string_view text, size_t* consumed) {
+        const char* first = text.data();
+        const char* last = first + text.size();
+        size_t rows, cols;
+        first = parseToken(skipSpaces(first, last), last, rows);
+        first = parseToken(skipSpaces(first, last), last, cols);
+        const size_t total = elementsCount(rows, cols);
+        // The header is untrusted: every value takes at least a separator and a digit.
+        if (total > static_cast<size_t>(last - first) / 2)
+            throw MatrixFormatException();
+        Matrix result(rows, cols);
+        if (total != 0) {
+            size_t count = total;
+            first = parseAvailable(first, last, result, 0, count);
+            if (count != total)
+                throw MatrixFormatException();
+        }
+        if (consumed)
+            *consumed = first - text.data();
+        return result;
+    }
+
+    Matrix readText(std::istream& in) {
+        TextBatches text(*in.rdbuf());
+        size_t rows, cols;
+        text.parse(rows);
+        text.parse(cols);
+        const size_t total = elementsCount(rows, cols);
+        if (total == 0)
+            return Matrix(rows, cols);
+        // The header is untrusted, as in parseText; when the stream cannot tell its length the
+        // result grows with the values actually read.
+        size_t allocatedRows = rows;
+        size_t remaining;
+        if (remainingBytes(in, remaining)) {
+            if (total > (text.getBufferedBytes() + remaining) / 2)
+                throw MatrixFormatException();
+        } else {
+            allocatedRows = std::min(rows, std::max<size_t>(1, UNKNOWN_SIZE_BLOCK / sizeof(double) / cols));
+        }
+        Matrix result(allocatedRows, cols);
+        for (size_t index = 0; index < total;) {
+            size_t count = total - index;
+            // A window of n bytes holds at most n / 2 + 1 tokens.
+            const size_t available = std::min(count, static_cast<size_t>(text.last() - text.first()) / 2 + 1);
+            const size_t neededRows = (index + available + cols - 1) / cols;
+            if (neededRows > result.getRowsCount())
+                result.resize(std::min(rows, std::max(neededRows, 2 * result.getRowsCount())), cols);
+            text.consume(parseAvailable(text.first(), text.last(), result, index, count));
+            index += count;
+            if (index < total && !text.next())
+                throw MatrixFormatException();
+        }
+        return result;
+    }
+
+    void writeText(std::ostream& out, const Matrix& matrix) {
+        const size_t rows = matrix.getRowsCount(), cols = matrix.getColumnsCount();
+        out << rows << ' ' << cols << '\n';
+        // Rows are formatted and written TEXT_BATCH_SIZE bytes at a time. Rows longer than that
+        // are cut into column slices; otherwise the blocks of a batch are formatted concurrently,
+        // each into its own buffer keyed by its first row.
+        const size_t sliceCols = std::max<size_t>(1, TEXT_BATCH_SIZE / FORMATTED_DOUBLE_SIZE);
+        if (cols > sliceCols) {
+            std::string slice(sliceCols * FORMATTED_DOUBLE_SIZE, ' ');
+            for (size_t i = 0; i < rows; ++i) {
+                const double* row = matrix.getData() + i * matrix.getStride();
+                for (size_t col = 0; col < cols; col += sliceCols) {
+                    const char* sliceEnd = formatRow(slice.data(), row + col, std::min(sliceCols, cols - col));
+                    out.write(slice.data(), sliceEnd - slice.data());
+                }
+                out.put('\n');
+            }
+            return;
+        }
+        const size_t rowSize = cols * FORMATTED_DOUBLE_SIZE + 1;
+        const size_t batchRows = std::max<size_t>(1, TEXT_BATCH_SIZE / rowSize);
+        std::vector<std::string> blocks(std::min(rows, batchRows));
+        for (size_t batch = 0; batch < rows; batch += batchRows) {
+            const size_t batchEnd = std::min(rows, batch + batchRows);
+            parallel::forRange(batchEnd - batch, cols * 64, [&](size_t begin, size_t end) {
+                std::string& block = blocks[begin];
+                block.resize((end - begin) * rowSize);
+                char* position = block.data();
+                for (size_t i = batch + begin; i < batch + end; ++i) {
+                    position = formatRow(position, matrix.getData() + i * matrix.getStride(), cols);
+                    *position++ = '\n';
+                }
+                block.resize(position - block.data());
+            });
+            for (size_t i = 0; i < batchEnd - batch; ++i) {
+                out.write(blocks[i].data(), blocks[i].size());
+                blocks[i].clear();
+            }
+        }
+    }
+
+    BinaryWriter::BinaryWriter(std::ostream& out, size_t rows, size_t cols)
+        : out(out), rows(rows), cols(cols), written(0) {
+        unsigned char header[HEADER_SIZE];
+        encodeHeader(header, rows, cols);
+        out.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+        writePadding(out, std::max(HEADER_SIZE, BINARY_ALIGNMENT) - HEADER_SIZE);
+        check();
+    }
+
+    void BinaryWriter::check() {
+        if (!out)
+            throw std::ios_base::failure("binary matrix write failed");
+    }
+
+    void BinaryWriter::writeRow(const double* row) {
+        if (written == rows)
+            throw SizeMismatchException();
+        out.write(reinterpret_cast<const char*>(row), cols * sizeof(double));
+        check();
+        ++written;
+    }
+
+    void BinaryWriter::writeRow(const RowView& row) {
+        if (row.size() != cols)
+            throw SizeMismatchException();
+        writeRow(row.begin());
+    }
+
+    void BinaryWriter::finish() {
+        if (written != rows)
+            throw SizeMismatchException();
+        out.flush();
+        check();
+    }
+
+    size_t BinaryWriter::getWrittenRowsCount() const {
+        return written;
+    }
+
+    void writeBinary(std::ostream& out, const Matrix& matrix) {
+        BinaryWriter writer(out, matrix.getRowsCount(), matrix.getColumnsCount());
+        for (size_t i = 0; i < matrix.getRowsCount(); ++i)
+            writer.writeRow(matrix.getRowView(i));
+        writer.finish();
+    }
+
+    Matrix readBinary(std::istream& in) {
+        unsigned char buffer[HEADER_SIZE];
+        if (!in.read(reinterpret_cast<char*>(buffer), HEADER_SIZE))
+            throw MatrixFormatException();
+        Header header = decodeHeader(buffer);
+        if (!in.ignore(header.offset - HEADER_SIZE))
+            throw MatrixFormatException();
+        if (header.cols == 0)
+            return Matrix(header.rows, 0);
+        const size_t rowSize = header.cols * sizeof(double);
+        // The header is untrusted: compare it with what the stream holds before allocating.
+        size_t allocatedRows = header.rows;
+        size_t remaining;
+        if (remainingBytes(in, remaining)) {
+            if (remaining / rowSize < header.rows)
+                throw MatrixFormatException();
+        } else {
+            allocatedRows = std::min(header.rows, std::max<size_t>(1, UNKNOWN_SIZE_BLOCK / rowSize));
+        }
+        Matrix result(allocatedRows, header.cols);
+        for (size_t i = 0; i < header.rows; ++i) {
+            if (i == result.getRowsCount())
+                result.resize(std::min(header.rows, 2 * i), header.cols);
+            double* row = result.getData() + i * result.getStride();
+            if (!in.read(reinterpret_cast<char*>(row), rowSize))
+                throw MatrixFormatException();
+            if (header.swapBytes)
+                for (size_t j = 0; j < header.cols; ++j)
+                    row[j] = swapped(row[j]);
+        }
+        return result;
+    }
+
+    MappedMatrix::MappedMatrix(const std::string& path)
+        : mapping(nullptr), mappingSize(0), matrix(map(path, mapping, mappingSize)) {}
+
+    Matrix MappedMatrix::map(const std::string& path, void*& mapping, size_t& mappingSize) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), path);
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), path);
+        }
+        if (static_cast<size_t>(info.st_size) < HEADER_SIZE) {
+            close(fd);
+            throw MatrixFormatException();
+        }
+        const size_t size = info.st_size;
+        void* bytes = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        int error = errno;
+        close(fd);
+        if (bytes == MAP_FAILED)
+            throw std::system_error(error, std::generic_category(), path);
+        try {
+            Header header = decodeHeader(static_cast<const unsigned char*>(bytes));
+            if (header.swapBytes || header.offset % alignof(double) != 0 || size < header.offset)
+                throw MatrixFormatException();
+            if (header.cols != 0 && (size - header.offset) / sizeof(double) / header.cols < header.rows)
+                throw MatrixFormatException();
+            const double* data = reinterpret_cast<const double*>(static_cast<const unsigned char*>(bytes) + header.offset);
+            mapping = bytes;
+            mappingSize = size;
+            return Matrix(Matrix::Borrowed(), data, header.rows, header.cols);
+        } catch (...) {
+            munmap(bytes, size);
+            throw;
+        }
+    }
+
+    MappedMatrix::MappedMatrix(MappedMatrix&& other) noexcept
+        : mapping(other.mapping), mappingSize(other.mappingSize), matrix(std::move(other.matrix)) {
+        other.mapping = nullptr;
+        other.mappingSize = 0;
+    }
+
+    MappedMatrix& MappedMatrix::operator=(MappedMatrix&& other) noexcept {
+        if (&other == this)
+            return *this;
+        release();
+        mapping = other.mapping;
+        mappingSize = other.mappingSize;
+        matrix = std::move(other.matrix);
+        other.mapping = nullptr;
+        other.mappingSize = 0;
+        return *this;
+    }
+
+    MappedMatrix::~MappedMatrix() {
+        release();
+    }
+
+    void MappedMatrix::release() {
+        if (mapping)
+            munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+
+}  // namespace task
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "matrix.h"
+
+namespace task {
+
+    class MatrixFormatException : public std::exception {};
+
+    // Binary layout: a 64-byte header followed by rows * cols doubles in row-major order,
+    // starting at BINARY_ALIGNMENT so the payload can be mapped and used in place.
+    //
+    //   offset  size  field
+    //   0       4     magic "TMAT"
+    //   4       1     version (1)
+    //   5       1     dtype (1 = IEEE-754 double)
+    //   6       1     byte order of all following fields (1 = little, 2 = big endian)
+    //   7       1     reserved
+    //   8       4     alignment of the payload
+    //   12      4     payload offset
+    //   16      8     rows
+    //   24      8     cols
+    //   32      32    reserved, zero
+    const size_t BINARY_ALIGNMENT = 64;
+
+    // Streams a matrix to `out` one row at a time; the row count and width are fixed upfront.
+    // A stream that goes bad throws std::ios_base::failure, and finish() must be called once
+    // the last row is written: it flushes and throws SizeMismatchException if rows are missing.
+    class BinaryWriter {
+    private:
+        std::ostream& out;
+        size_t rows, cols;
+        size_t written;
+
+        void check();
+
+    public:
+        BinaryWriter(std::ostream&, size_t, size_t);
+
+        void writeRow(const double*);
+        void writeRow(const RowView&);
+        void finish();
+
+        size_t getWrittenRowsCount() const;
+    };
+
+    void writeBinary(std::ostream&, const Matrix&);
+    // Throws MatrixFormatException, before allocating anything, if the stream is shorter than
+    // the header claims; streams that cannot seek are read in growing blocks instead.
+    Matrix readBinary(std::istream&);
+
+    // Bulk versions of operator>> and operator<< for the text format: rows, cols and then the
+    // values in row-major order, all separated by whitespace.
+    //
+    // parseText converts the buffer with std::from_chars. Once the text reaches a megabyte it is
+    // cut into chunks at whitespace, and with more than one thread (see parallel::setThreadsCount)
+    // the chunks are tokenized and parsed concurrently. Anything after the last value is left
+    // alone; its offset is stored in `consumed` if given. Malformed or short input throws
+    // MatrixFormatException, and a header claiming more values than the text could hold does
+    // so before anything is allocated.
+    Matrix parseText(std::string_view, size_t* consumed = nullptr);
+
+    // Parses the stream like parseText, reading it in batches of a few megabytes into one reused
+    // buffer. Text past the matrix may be consumed too, so it suits files and pipes that hold a
+    // single matrix. Streams that cannot seek grow the result as values arrive instead of
+    // trusting the header.
+    Matrix readText(std::istream&);
+
+    // Writes the header line and then the rows in the layout of operator<<, each value in the
+    // shortest form that parses back to the same double (std::to_chars). The text is produced
+    // and written in batches of a few megabytes, each formatted in row blocks on the thread pool.
+    void writeText(std::ostream&, const Matrix&);
+
+    // Read-only matrix backed by a memory-mapped binary file. Pages are loaded lazily by the
+    // OS and nothing is parsed or copied: getMatrix() is a Matrix whose storage is the mapping
+    // itself, so det(), operator*, solve() and the rest run straight on the file. It stays
+    // valid as long as the MappedMatrix; copies of it own their storage as usual.
+    class MappedMatrix {
+    private:
+        void* mapping;
+        size_t mappingSize;
+        Matrix matrix;
+
+        static Matrix map(const std::string&, void*&, size_t&);
+        void release();
+
+    public:
+        explicit MappedMatrix(const std::string&);
+        MappedMatrix(MappedMatrix&&) noexcept;
+        MappedMatrix& operator=(MappedMatrix&&) noexcept;
+        ~MappedMatrix();
+
+        MappedMatrix(const MappedMatrix&) = delete;
+        MappedMatrix& operator=(const MappedMatrix&) = delete;
+
+        const Matrix& getMatrix() const { return matrix; }
+        operator const Matrix&() const { return matrix; }
+
+        size_t getRowsCount() const { return matrix.getRowsCount(); }
+        size_t getColumnsCount() const { return matrix.getColumnsCount(); }
+        const double& get(const size_t& row, const size_t& col) const { return matrix.get(row, col); }
+    };
+
+}  // namespace task
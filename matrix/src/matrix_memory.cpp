@@ -0,0 +1,96 @@
+#include "matrix_memory.h"
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+namespace task {
+
+    namespace {
+
+        // Size classes run from one cache line to 2^40 bytes; larger requests bypass the pool.
+        const size_t SIZE_CLASSES = 35;
+
+        std::atomic<std::pmr::memory_resource*> defaultResource{std::pmr::new_delete_resource()};
+
+        size_t sizeClass(size_t bytes) {
+            size_t index = 0;
+            while (index < SIZE_CLASSES && (MATRIX_ALIGNMENT << index) < bytes)
+                ++index;
+            return index;
+        }
+
+        size_t classBytes(size_t index) {
+            return MATRIX_ALIGNMENT << index;
+        }
+
+    }  // namespace
+
+    std::pmr::memory_resource* getDefaultMatrixResource() {
+        return defaultResource.load(std::memory_order_relaxed);
+    }
+
+    void setDefaultMatrixResource(std::pmr::memory_resource* resource) {
+        defaultResource.store(resource ? resource : std::pmr::new_delete_resource(), std::memory_order_relaxed);
+    }
+
+    MatrixPool::MatrixPool(size_t budget, std::pmr::memory_resource* upstream)
+        : upstream(upstream), budget(budget), cached(0), freeLists(SIZE_CLASSES, nullptr) {}
+
+    MatrixPool::~MatrixPool() {
+        release();
+    }
+
+    void* MatrixPool::do_allocate(size_t bytes, size_t alignment) {
+        const size_t index = sizeClass(bytes);
+        if (index == SIZE_CLASSES || alignment > MATRIX_ALIGNMENT)
+            return upstream->allocate(bytes, std::max(alignment, MATRIX_ALIGNMENT));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            FreeBuffer* buffer = freeLists[index];
+            if (buffer) {
+                freeLists[index] = buffer->next;
+                cached -= classBytes(index);
+                return buffer;
+            }
+        }
+        return upstream->allocate(classBytes(index), MATRIX_ALIGNMENT);
+    }
+
+    void MatrixPool::do_deallocate(void* buffer, size_t bytes, size_t alignment) {
+        const size_t index = sizeClass(bytes);
+        if (index == SIZE_CLASSES || alignment > MATRIX_ALIGNMENT) {
+            upstream->deallocate(buffer, bytes, std::max(alignment, MATRIX_ALIGNMENT));
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (cached + classBytes(index) <= budget) {
+                freeLists[index] = new (buffer) FreeBuffer{freeLists[index]};
+                cached += classBytes(index);
+                return;
+            }
+        }
+        upstream->deallocate(buffer, classBytes(index), MATRIX_ALIGNMENT);
+    }
+
+    bool MatrixPool::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+    void MatrixPool::release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t index = 0; index < SIZE_CLASSES; ++index) {
+            while (FreeBuffer* buffer = freeLists[index]) {
+                freeLists[index] = buffer->next;
+                upstream->deallocate(buffer, classBytes(index), MATRIX_ALIGNMENT);
+            }
+        }
+        cached = 0;
+    }
+
+    size_t MatrixPool::getCachedBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return cached;
+    }
+
+}  // namespace task
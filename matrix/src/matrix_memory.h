@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace task {
+
+    // Every Matrix buffer starts on a cache line, so vector loads never straddle two lines.
+    const size_t MATRIX_ALIGNMENT = 64;
+
+    // Resource used by matrices constructed without one, including every temporary produced by
+    // operators. Starts as std::pmr::new_delete_resource(); set it before spawning threads.
+    std::pmr::memory_resource* getDefaultMatrixResource();
+    void setDefaultMatrixResource(std::pmr::memory_resource*);
+
+    // Size-class pool for matrix buffers. Requests are rounded up to a power of two (at least
+    // one cache line); freed buffers are kept per class, most recently freed first, until the
+    // pool holds `budget` bytes, and anything beyond that goes back upstream. The free lists
+    // are threaded through the cached buffers themselves, so freeing never allocates or throws.
+    // Thread-safe. The pool must outlive every matrix allocated from it.
+    class MatrixPool : public std::pmr::memory_resource {
+    private:
+        // Header written into the first word of a cached buffer.
+        struct FreeBuffer {
+            FreeBuffer* next;
+        };
+
+        std::pmr::memory_resource* upstream;
+        size_t budget;
+        size_t cached;
+        std::vector<FreeBuffer*> freeLists;
+        mutable std::mutex mutex;
+
+        void* do_allocate(size_t, size_t) override;
+        void do_deallocate(void*, size_t, size_t) override;
+        bool do_is_equal(const std::pmr::memory_resource&) const noexcept override;
+
+    public:
+        explicit MatrixPool(size_t budget = size_t(256) << 20,
+                            std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+        ~MatrixPool();
+
+        MatrixPool(const MatrixPool&) = delete;
+        MatrixPool& operator=(const MatrixPool&) = delete;
+
+        // Returns every cached buffer to the upstream resource.
+        void release();
+        size_t getCachedBytes() const;
+    };
+
+}  // namespace task
@@ -0,0 +1,505 @@
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TASK_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// Bodies shared by several instruction sets have to be inlined into each target-specific copy.
+#ifdef __GNUC__
+#define TASK_SIMD_INLINE inline __attribute__((always_inline))
+#else
+#define TASK_SIMD_INLINE inline
+#endif
+
+namespace task {
+
+    namespace simd {
+
+        namespace {
+
+            const size_t TRANSPOSE_TILE = 32;
+
+            struct Kernels {
+                void (*add)(const double*, const double*, double*, size_t);
+                void (*subtract)(const double*, const double*, double*, size_t);
+                void (*scale)(const double*, double, double*, size_t);
+                void (*negate)(const double*, double*, size_t);
+                bool (*equal)(const double*, const double*, size_t, double);
+                void (*transpose4x4)(const double*, size_t, double*, size_t);
+                void (*batchMultiply)(const double*, size_t, const double*, size_t, double*, size_t, size_t, size_t, size_t);
+                void (*batchDet)(const double*, size_t, size_t, double*, double*);
+                const char* name;
+            };
+
+            void addScalar(const double* a, const double* b, double* out, size_t n) {
+                for (size_t i = 0; i < n; ++i)
+                    out[i] = a[i] + b[i];
+            }
+
+            void subtractScalar(const double* a, const double* b, double* out, size_t n) {
+                for (size_t i = 0; i < n; ++i)
+                    out[i] = a[i] - b[i];
+            }
+
+            void scaleScalar(const double* a, double number, double* out, size_t n) {
+                for (size_t i = 0; i < n; ++i)
+                    out[i] = a[i] * number;
+            }
+
+            void negateScalar(const double* a, double* out, size_t n) {
+                for (size_t i = 0; i < n; ++i)
+                    out[i] = -a[i];
+            }
+
+            bool equalScalar(const double* a, const double* b, size_t n, double eps) {
+                for (size_t i = 0; i < n; ++i) {
+                    double diff = a[i] - b[i];
+                    if ((diff < 0 ? -diff : diff) > eps)
+                        return false;
+                }
+                return true;
+            }
+
+            // Block kernels read the whole 4x4 block before writing, so src may equal dst.
+            void transpose4x4Scalar(const double* src, size_t srcStride, double* dst, size_t dstStride) {
+                double block[4][4];
+                for (size_t i = 0; i < 4; ++i)
+                    for (size_t j = 0; j < 4; ++j)
+                        block[j][i] = src[i * srcStride + j];
+                for (size_t i = 0; i < 4; ++i)
+                    for (size_t j = 0; j < 4; ++j)
+                        dst[i * dstStride + j] = block[i][j];
+            }
+
+            // The batch kernels are written once with every inner loop running over the
+            // BATCH_LANES lanes; the copies below are compiled for each instruction set and the
+            // compiler vectorizes those loops with its registers. The lane helpers take restrict
+            // pointers so that no runtime alias checks are needed for that.
+            TASK_SIMD_INLINE
+            void lanesMultiplyAdd(double* __restrict out, const double* __restrict a, const double* __restrict b) {
+                for (size_t l = 0; l < BATCH_LANES; ++l)
+                    out[l] += a[l] * b[l];
+            }
+
+            TASK_SIMD_INLINE
+            void lanesMultiplySubtract(double* __restrict out, const double* __restrict a, const double* __restrict b) {
+                for (size_t l = 0; l < BATCH_LANES; ++l)
+                    out[l] -= a[l] * b[l];
+            }
+
+            // Exchanges a[l] and b[l] in the lanes where mask[l] is all ones. Done on the bits,
+            // since compilers do not if-convert the equivalent conditional moves of doubles.
+            TASK_SIMD_INLINE
+            void lanesSwap(const uint64_t* __restrict mask, double* __restrict a, double* __restrict b) {
+                for (size_t l = 0; l < BATCH_LANES; ++l) {
+                    uint64_t x, y;
+                    std::memcpy(&x, a + l, sizeof(x));
+                    std::memcpy(&y, b + l, sizeof(y));
+                    const uint64_t difference = (x ^ y) & mask[l];
+                    x ^= difference;
+                    y ^= difference;
+                    std::memcpy(a + l, &x, sizeof(x));
+                    std::memcpy(b + l, &y, sizeof(y));
+                }
+            }
+
+            TASK_SIMD_INLINE
+            void batchMultiplyLanes(const double* a, size_t strideA, const double* b, size_t strideB,
+                                    double* c, size_t strideC, size_t m, size_t k, size_t n) {
+                for (size_t i = 0; i < m; ++i)
+                    for (size_t j = 0; j < n; ++j) {
+                        double* out = c + (i * n + j) * strideC;
+                        std::fill(out, out + BATCH_LANES, 0.);
+                        for (size_t p = 0; p < k; ++p)
+                            lanesMultiplyAdd(out, a + (i * k + p) * strideA, b + (p * n + j) * strideB);
+                    }
+            }
+
+            // Pivoting compares every candidate row with the current pivot row and blends the two
+            // wherever the candidate is larger, which leaves the largest entry on the diagonal.
+            TASK_SIMD_INLINE
+            void batchDetLanes(const double* a, size_t stride, size_t n, double* det, double* work) {
+                for (size_t e = 0; e < n * n; ++e)
+                    std::copy(a + e * stride, a + e * stride + BATCH_LANES, work + e * BATCH_LANES);
+                double result[BATCH_LANES];
+                uint64_t mask[BATCH_LANES];
+                std::fill(result, result + BATCH_LANES, 1.);
+                for (size_t k = 0; k < n; ++k) {
+                    double* pivotRow = work + k * n * BATCH_LANES;
+                    for (size_t r = k + 1; r < n; ++r) {
+                        double* row = work + r * n * BATCH_LANES;
+                        for (size_t l = 0; l < BATCH_LANES; ++l) {
+                            const bool larger = std::abs(row[k * BATCH_LANES + l]) > std::abs(pivotRow[k * BATCH_LANES + l]);
+                            mask[l] = larger ? ~uint64_t(0) : 0;
+                            result[l] = larger ? -result[l] : result[l];
+                        }
+                        for (size_t c = k; c < n; ++c)
+                            lanesSwap(mask, pivotRow + c * BATCH_LANES, row + c * BATCH_LANES);
+                    }
+                    double inverse[BATCH_LANES], factor[BATCH_LANES];
+                    for (size_t l = 0; l < BATCH_LANES; ++l) {
+                        const double pivot = pivotRow[k * BATCH_LANES + l];
+                        result[l] *= pivot;
+                        inverse[l] = pivot != 0 ? 1 / pivot : 0;
+                    }
+                    for (size_t r = k + 1; r < n; ++r) {
+                        double* row = work + r * n * BATCH_LANES;
+                        for (size_t l = 0; l < BATCH_LANES; ++l)
+                            factor[l] = row[k * BATCH_LANES + l] * inverse[l];
+                        for (size_t c = k + 1; c < n; ++c)
+                            lanesMultiplySubtract(row + c * BATCH_LANES, factor, pivotRow + c * BATCH_LANES);
+                    }
+                }
+                std::copy(result, result + BATCH_LANES, det);
+            }
+
+            void batchMultiplyScalar(const double* a, size_t strideA, const double* b, size_t strideB,
+                                     double* c, size_t strideC, size_t m, size_t k, size_t n) {
+                batchMultiplyLanes(a, strideA, b, strideB, c, strideC, m, k, n);
+            }
+
+            void batchDetScalar(const double* a, size_t stride, size_t n, double* det, double* work) {
+                batchDetLanes(a, stride, n, det, work);
+            }
+
+#ifdef TASK_SIMD_X86
+
+            __attribute__((target("sse2")))
+            void addSse2(const double* a, const double* b, double* out, size_t n) {
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                    _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+                addScalar(a + i, b + i, out + i, n - i);
+            }
+
+            __attribute__((target("sse2")))
+            void subtractSse2(const double* a, const double* b, double* out, size_t n) {
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                    _mm_storeu_pd(out + i, _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+                subtractScalar(a + i, b + i, out + i, n - i);
+            }
+
+            __attribute__((target("sse2")))
+            void scaleSse2(const double* a, double number, double* out, size_t n) {
+                const __m128d factor = _mm_set1_pd(number);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                    _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(a + i), factor));
+                scaleScalar(a + i, number, out + i, n - i);
+            }
+
+            __attribute__((target("sse2")))
+            void negateSse2(const double* a, double* out, size_t n) {
+                const __m128d sign = _mm_set1_pd(-0.);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                    _mm_storeu_pd(out + i, _mm_xor_pd(_mm_loadu_pd(a + i), sign));
+                negateScalar(a + i, out + i, n - i);
+            }
+
+            __attribute__((target("sse2")))
+            bool equalSse2(const double* a, const double* b, size_t n, double eps) {
+                const __m128d sign = _mm_set1_pd(-0.);
+                const __m128d bound = _mm_set1_pd(eps);
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2) {
+                    __m128d diff = _mm_andnot_pd(sign, _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+                    if (_mm_movemask_pd(_mm_cmpgt_pd(diff, bound)))
+                        return false;
+                }
+                return equalScalar(a + i, b + i, n - i, eps);
+            }
+
+            __attribute__((target("sse2")))
+            void transpose4x4Sse2(const double* src, size_t srcStride, double* dst, size_t dstStride) {
+                __m128d rows[4][2];
+                for (size_t i = 0; i < 4; ++i) {
+                    rows[i][0] = _mm_loadu_pd(src + i * srcStride);
+                    rows[i][1] = _mm_loadu_pd(src + i * srcStride + 2);
+                }
+                for (size_t i = 0; i < 4; i += 2)
+                    for (size_t half = 0; half < 2; ++half) {
+                        double* out = dst + (2 * half) * dstStride + i;
+                        _mm_storeu_pd(out, _mm_unpacklo_pd(rows[i][half], rows[i + 1][half]));
+                        _mm_storeu_pd(out + dstStride, _mm_unpackhi_pd(rows[i][half], rows[i + 1][half]));
+                    }
+            }
+
+            __attribute__((target("avx2")))
+            void addAvx2(const double* a, const double* b, double* out, size_t n) {
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+                addScalar(a + i, b + i, out + i, n - i);
+            }
+
+            __attribute__((target("avx2")))
+            void subtractAvx2(const double* a, const double* b, double* out, size_t n) {
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+                subtractScalar(a + i, b + i, out + i, n - i);
+            }
+
+            __attribute__((target("avx2")))
+            void scaleAvx2(const double* a, double number, double* out, size_t n) {
+                const __m256d factor = _mm256_set1_pd(number);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), factor));
+                scaleScalar(a + i, number, out + i, n - i);
+            }
+
+            __attribute__((target("avx2")))
+            void negateAvx2(const double* a, double* out, size_t n) {
+                const __m256d sign = _mm256_set1_pd(-0.);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4)
+                    _mm256_storeu_pd(out + i, _mm256_xor_pd(_mm256_loadu_pd(a + i), sign));
+                negateScalar(a + i, out + i, n - i);
+            }
+
+            __attribute__((target("avx2")))
+            bool equalAvx2(const double* a, const double* b, size_t n, double eps) {
+                const __m256d sign = _mm256_set1_pd(-0.);
+                const __m256d bound = _mm256_set1_pd(eps);
+                size_t i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    __m256d diff = _mm256_andnot_pd(sign, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+                    if (_mm256_movemask_pd(_mm256_cmp_pd(diff, bound, _CMP_GT_OQ)))
+                        return false;
+                }
+                return equalScalar(a + i, b + i, n - i, eps);
+            }
+
+            __attribute__((target("avx2")))
+            void transpose4x4Avx2(const double* src, size_t srcStride, double* dst, size_t dstStride) {
+                __m256d row0 = _mm256_loadu_pd(src);
+                __m256d row1 = _mm256_loadu_pd(src + srcStride);
+                __m256d row2 = _mm256_loadu_pd(src + 2 * srcStride);
+                __m256d row3 = _mm256_loadu_pd(src + 3 * srcStride);
+                __m256d low01 = _mm256_unpacklo_pd(row0, row1);
+                __m256d high01 = _mm256_unpackhi_pd(row0, row1);
+                __m256d low23 = _mm256_unpacklo_pd(row2, row3);
+                __m256d high23 = _mm256_unpackhi_pd(row2, row3);
+                _mm256_storeu_pd(dst, _mm256_permute2f128_pd(low01, low23, 0x20));
+                _mm256_storeu_pd(dst + dstStride, _mm256_permute2f128_pd(high01, high23, 0x20));
+                _mm256_storeu_pd(dst + 2 * dstStride, _mm256_permute2f128_pd(low01, low23, 0x31));
+                _mm256_storeu_pd(dst + 3 * dstStride, _mm256_permute2f128_pd(high01, high23, 0x31));
+            }
+
+            __attribute__((target("avx512f")))
+            void addAvx512(const double* a, const double* b, double* out, size_t n) {
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                    _mm512_storeu_pd(out + i, _mm512_add_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+                addScalar(a + i, b + i, out + i, n - i);
+            }
+
+            __attribute__((target("avx512f")))
+            void subtractAvx512(const double* a, const double* b, double* out, size_t n) {
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                    _mm512_storeu_pd(out + i, _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+                subtractScalar(a + i, b + i, out + i, n - i);
+            }
+
+            __attribute__((target("avx512f")))
+            void scaleAvx512(const double* a, double number, double* out, size_t n) {
+                const __m512d factor = _mm512_set1_pd(number);
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8)
+                    _mm512_storeu_pd(out + i, _mm512_mul_pd(_mm512_loadu_pd(a + i), factor));
+                scaleScalar(a + i, number, out + i, n - i);
+            }
+
+            __attribute__((target("avx512f")))
+            void negateAvx512(const double* a, double* out, size_t n) {
+                const __m512i sign = _mm512_set1_epi64(static_cast<long long>(1ULL << 63));
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    __m512i bits = _mm512_castpd_si512(_mm512_loadu_pd(a + i));
+                    _mm512_storeu_pd(out + i, _mm512_castsi512_pd(_mm512_xor_si512(bits, sign)));
+                }
+                negateScalar(a + i, out + i, n - i);
+            }
+
+            __attribute__((target("avx512f")))
+            bool equalAvx512(const double* a, const double* b, size_t n, double eps) {
+                const __m512d bound = _mm512_set1_pd(eps);
+                size_t i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    __m512d diff = _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+                    if (_mm512_cmp_pd_mask(diff, bound, _CMP_GT_OQ))
+                        return false;
+                }
+                return equalScalar(a + i, b + i, n - i, eps);
+            }
+
+            __attribute__((target("avx2")))
+            void batchMultiplyAvx2(const double* a, size_t strideA, const double* b, size_t strideB,
+                                   double* c, size_t strideC, size_t m, size_t k, size_t n) {
+                batchMultiplyLanes(a, strideA, b, strideB, c, strideC, m, k, n);
+            }
+
+            __attribute__((target("avx2")))
+            void batchDetAvx2(const double* a, size_t stride, size_t n, double* det, double* work) {
+                batchDetLanes(a, stride, n, det, work);
+            }
+
+            __attribute__((target("avx512f")))
+            void batchMultiplyAvx512(const double* a, size_t strideA, const double* b, size_t strideB,
+                                     double* c, size_t strideC, size_t m, size_t k, size_t n) {
+                batchMultiplyLanes(a, strideA, b, strideB, c, strideC, m, k, n);
+            }
+
+            __attribute__((target("avx512f")))
+            void batchDetAvx512(const double* a, size_t stride, size_t n, double* det, double* work) {
+                batchDetLanes(a, stride, n, det, work);
+            }
+
+#endif
+
+            // Fills table with the kernels of the named instruction set if the CPU supports it.
+            bool lookup(const std::string& name, Kernels& table) {
+#ifdef TASK_SIMD_X86
+                __builtin_cpu_init();
+                if (name == "avx512" && __builtin_cpu_supports("avx512f")) {
+                    table = {addAvx512, subtractAvx512, scaleAvx512, negateAvx512, equalAvx512, transpose4x4Avx2,
+                             batchMultiplyAvx512, batchDetAvx512, "avx512"};
+                    return true;
+                }
+                if (name == "avx2" && __builtin_cpu_supports("avx2")) {
+                    table = {addAvx2, subtractAvx2, scaleAvx2, negateAvx2, equalAvx2, transpose4x4Avx2,
+                             batchMultiplyAvx2, batchDetAvx2, "avx2"};
+                    return true;
+                }
+                if (name == "sse2" && __builtin_cpu_supports("sse2")) {
+                    table = {addSse2, subtractSse2, scaleSse2, negateSse2, equalSse2, transpose4x4Sse2,
+                             batchMultiplyScalar, batchDetScalar, "sse2"};
+                    return true;
+                }
+#endif
+                if (name == "scalar") {
+                    table = {addScalar, subtractScalar, scaleScalar, negateScalar, equalScalar, transpose4x4Scalar,
+                             batchMultiplyScalar, batchDetScalar, "scalar"};
+                    return true;
+                }
+                return false;
+            }
+
+            Kernels select() {
+                Kernels table;
+                for (const char* name : {"avx512", "avx2", "sse2"})
+                    if (lookup(name, table))
+                        return table;
+                lookup("scalar", table);
+                return table;
+            }
+
+            Kernels& kernels() {
+                static Kernels table = select();
+                return table;
+            }
+
+        }  // namespace
+
+        void add(const double* a, const double* b, double* out, size_t n) {
+            kernels().add(a, b, out, n);
+        }
+
+        void subtract(const double* a, const double* b, double* out, size_t n) {
+            kernels().subtract(a, b, out, n);
+        }
+
+        void scale(const double* a, double number, double* out, size_t n) {
+            kernels().scale(a, number, out, n);
+        }
+
+        void negate(const double* a, double* out, size_t n) {
+            kernels().negate(a, out, n);
+        }
+
+        bool equal(const double* a, const double* b, size_t n, double eps) {
+            return kernels().equal(a, b, n, eps);
+        }
+
+        void transpose(const double* src, size_t srcStride, double* dst, size_t dstStride, size_t rows, size_t cols) {
+            const auto kernel = kernels().transpose4x4;
+            for (size_t tileRow = 0; tileRow < rows; tileRow += TRANSPOSE_TILE)
+                for (size_t tileCol = 0; tileCol < cols; tileCol += TRANSPOSE_TILE) {
+                    const size_t rowEnd = std::min(rows, tileRow + TRANSPOSE_TILE);
+                    const size_t colEnd = std::min(cols, tileCol + TRANSPOSE_TILE);
+                    for (size_t i = tileRow; i < rowEnd; i += 4)
+                        for (size_t j = tileCol; j < colEnd; j += 4) {
+                            if (i + 4 <= rowEnd && j + 4 <= colEnd) {
+                                kernel(src + i * srcStride + j, srcStride, dst + j * dstStride + i, dstStride);
+                                continue;
+                            }
+                            for (size_t ii = i; ii < std::min(i + 4, rowEnd); ++ii)
+                                for (size_t jj = j; jj < std::min(j + 4, colEnd); ++jj)
+                                    dst[jj * dstStride + ii] = src[ii * srcStride + jj];
+                        }
+                }
+        }
+
+        void transposeSquare(double* data, size_t stride, size_t n) {
+            const auto kernel = kernels().transpose4x4;
+            double mirrored[16];
+            for (size_t tileRow = 0; tileRow < n; tileRow += TRANSPOSE_TILE)
+                for (size_t tileCol = tileRow; tileCol < n; tileCol += TRANSPOSE_TILE) {
+                    const size_t rowEnd = std::min(n, tileRow + TRANSPOSE_TILE);
+                    const size_t colEnd = std::min(n, tileCol + TRANSPOSE_TILE);
+                    for (size_t i = tileRow; i < rowEnd; i += 4)
+                        for (size_t j = (tileRow == tileCol ? i : tileCol); j < colEnd; j += 4) {
+                            double* upper = data + i * stride + j;
+                            double* lower = data + j * stride + i;
+                            if (i + 4 <= n && j + 4 <= n) {
+                                if (i == j) {
+                                    kernel(upper, stride, upper, stride);
+                                } else {
+                                    kernel(upper, stride, mirrored, 4);
+                                    kernel(lower, stride, upper, stride);
+                                    for (size_t k = 0; k < 4; ++k)
+                                        std::copy(mirrored + 4 * k, mirrored + 4 * k + 4, lower + k * stride);
+                                }
+                                continue;
+                            }
+                            for (size_t ii = i; ii < std::min(i + 4, n); ++ii)
+                                for (size_t jj = (i == j ? ii + 1 : j); jj < std::min(j + 4, n); ++jj)
+                                    std::swap(data[ii * stride + jj], data[jj * stride + ii]);
+                        }
+                }
+        }
+
+        void batchMultiply(const double* a, size_t strideA, const double* b, size_t strideB,
+                           double* c, size_t strideC, size_t m, size_t k, size_t n) {
+            kernels().batchMultiply(a, strideA, b, strideB, c, strideC, m, k, n);
+        }
+
+        void batchDet(const double* a, size_t stride, size_t n, double* det, double* scratch) {
+            kernels().batchDet(a, stride, n, det, scratch);
+        }
+
+        const char* instructionSet() {
+            return kernels().name;
+        }
+
+        bool useInstructionSet(const char* name) {
+            if (!name) {
+                kernels() = select();
+                return true;
+            }
+            return lookup(name, kernels());
+        }
+
+    }  // namespace simd
+
+}  // namespace task
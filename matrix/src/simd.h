@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+namespace task {
+
+    namespace simd {
+
+        // Elementwise kernels over n doubles. The widest instruction set supported by the
+        // running CPU (AVX-512, AVX2, SSE2 or plain scalar code) is picked on first use.
+        // Output may alias any of the inputs.
+
+        void add(const double* a, const double* b, double* out, size_t n);
+        void subtract(const double* a, const double* b, double* out, size_t n);
+        void scale(const double* a, double number, double* out, size_t n);
+        void negate(const double* a, double* out, size_t n);
+
+        // True if |a[i] - b[i]| <= eps for every i; stops at the first mismatching vector.
+        bool equal(const double* a, const double* b, size_t n, double eps);
+
+        // Writes the transpose of the rows x cols block at src into dst, going through
+        // cache-sized tiles made of 4x4 register transposes.
+        void transpose(const double* src, size_t srcStride, double* dst, size_t dstStride, size_t rows, size_t cols);
+
+        // Transposes the n x n block at data in place by swapping mirrored tiles.
+        void transposeSquare(double* data, size_t stride, size_t n);
+
+        // Batch kernels work on BATCH_LANES matrices at once, stored element-major: element
+        // (i, j) of matrix l sits at data[(i * cols + j) * stride + l], so every vector holds one
+        // element of consecutive matrices and no shuffles are needed.
+        const size_t BATCH_LANES = 16;
+
+        // C = A * B for BATCH_LANES pairs of m x k and k x n matrices. C must not alias A or B.
+        void batchMultiply(const double* a, size_t strideA, const double* b, size_t strideB,
+                           double* c, size_t strideC, size_t m, size_t k, size_t n);
+
+        // Determinants of BATCH_LANES n x n matrices by Gaussian elimination with partial pivoting,
+        // where rows are exchanged by per-lane blends. scratch holds n * n * BATCH_LANES doubles.
+        void batchDet(const double* a, size_t stride, size_t n, double* det, double* scratch);
+
+        const char* instructionSet();
+
+        // Switches every kernel above to one instruction set ("avx512", "avx2", "sse2" or
+        // "scalar"), or back to the automatic choice for nullptr, so that tests can run each
+        // implementation the CPU supports. Returns false and changes nothing if the CPU lacks
+        // the set. Not thread-safe: only call it while no kernel is running.
+        bool useInstructionSet(const char* name);
+
+    }  // namespace simd
+
+}  // namespace task
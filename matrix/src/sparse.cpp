@@ -0,0 +1,371 @@
+#include "sparse.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+namespace task {
+
+    CsrMatrix::CsrMatrix() : CsrMatrix(0, 0) {}
+
+    CsrMatrix::CsrMatrix(const size_t& rows, const size_t& cols) : rows(rows), cols(cols), offsets(rows + 1, 0) {}
+
+    CsrMatrix::CsrMatrix(const Matrix& matrix) : CsrMatrix(matrix.getRowsCount(), matrix.getColumnsCount()) {
+        for (size_t i = 0; i < rows; ++i) {
+            RowView row = matrix.getRowView(i);
+            for (size_t j = 0; j < cols; ++j)
+                if (row[j] != 0.) {
+                    indices.push_back(j);
+                    values.push_back(row[j]);
+                }
+            offsets[i + 1] = values.size();
+        }
+    }
+
+    CsrMatrix::CsrMatrix(const CscMatrix& matrix) : CsrMatrix(matrix.toCsr()) {}
+
+    CsrMatrix::CsrMatrix(const size_t& rows, const size_t& cols, std::vector<Triplet> entries)
+        : CsrMatrix(rows, cols) {
+        for (const Triplet& entry : entries)
+            if (entry.row >= rows || entry.col >= cols)
+                throw OutOfBoundsException();
+        std::sort(entries.begin(), entries.end(), [](const Triplet& left, const Triplet& right) {
+            return left.row != right.row ? left.row < right.row : left.col < right.col;
+        });
+        for (size_t k = 0; k < entries.size();) {
+            const size_t row = entries[k].row, col = entries[k].col;
+            double sum = 0.;
+            for (; k < entries.size() && entries[k].row == row && entries[k].col == col; ++k)
+                sum += entries[k].value;
+            if (sum != 0.) {
+                indices.push_back(col);
+                values.push_back(sum);
+                ++offsets[row + 1];
+            }
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    }
+
+    size_t CsrMatrix::getRowsCount() const {
+        return rows;
+    }
+
+    size_t CsrMatrix::getColumnsCount() const {
+        return cols;
+    }
+
+    size_t CsrMatrix::getNonZerosCount() const {
+        return values.size();
+    }
+
+    double CsrMatrix::get(const size_t& row, const size_t& col) const {
+        if (row >= rows || col >= cols)
+            throw OutOfBoundsException();
+        auto begin = indices.begin() + offsets[row], end = indices.begin() + offsets[row + 1];
+        auto found = std::lower_bound(begin, end, col);
+        return found != end && *found == col ? values[found - indices.begin()] : 0.;
+    }
+
+    const std::vector<size_t>& CsrMatrix::getOffsets() const {
+        return offsets;
+    }
+
+    const std::vector<size_t>& CsrMatrix::getIndices() const {
+        return indices;
+    }
+
+    const std::vector<double>& CsrMatrix::getValues() const {
+        return values;
+    }
+
+    Matrix CsrMatrix::toMatrix() const {
+        Matrix result = Matrix::zeros(rows, cols);
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t k = offsets[i]; k < offsets[i + 1]; ++k)
+                result.set(i, indices[k], values[k]);
+        return result;
+    }
+
+    CscMatrix CsrMatrix::toCsc() const {
+        return CscMatrix(*this);
+    }
+
+    std::vector<double> CsrMatrix::operator*(const std::vector<double>& vector) const {
+        if (vector.size() != cols)
+            throw SizeMismatchException();
+        std::vector<double> result(rows);
+        parallel::forRange(rows, values.size() / std::max<size_t>(1, rows) + 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                double sum = 0.;
+                for (size_t k = offsets[i]; k < offsets[i + 1]; ++k)
+                    sum += values[k] * vector[indices[k]];
+                result[i] = sum;
+            }
+        });
+        return result;
+    }
+
+    Matrix CsrMatrix::operator*(const Matrix& mult) const {
+        if (mult.getRowsCount() != cols)
+            throw SizeMismatchException();
+        const size_t width = mult.getColumnsCount();
+        Matrix result = Matrix::zeros(rows, width);
+        if (width == 0)
+            return result;
+        const size_t rowCost = (values.size() / std::max<size_t>(1, rows) + 1) * width;
+        parallel::forRange(rows, rowCost, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                double* out = &result.get(i, 0);
+                for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                    const double* in = mult.getRowView(indices[k]).begin();
+                    for (size_t j = 0; j < width; ++j)
+                        out[j] += values[k] * in[j];
+                }
+            }
+        });
+        return result;
+    }
+
+    // this + sign * other, merging the sorted column lists row by row.
+    CsrMatrix CsrMatrix::merged(const CsrMatrix& other, const double& sign) const {
+        if (other.rows != rows || other.cols != cols)
+            throw SizeMismatchException();
+        CsrMatrix result(rows, cols);
+        result.indices.reserve(values.size() + other.values.size());
+        result.values.reserve(values.size() + other.values.size());
+        for (size_t i = 0; i < rows; ++i) {
+            size_t left = offsets[i], right = other.offsets[i];
+            const size_t leftEnd = offsets[i + 1], rightEnd = other.offsets[i + 1];
+            while (left < leftEnd || right < rightEnd) {
+                size_t col;
+                double value;
+                if (right == rightEnd || (left < leftEnd && indices[left] < other.indices[right])) {
+                    col = indices[left];
+                    value = values[left++];
+                } else if (left == leftEnd || other.indices[right] < indices[left]) {
+                    col = other.indices[right];
+                    value = sign * other.values[right++];
+                } else {
+                    col = indices[left];
+                    value = values[left++] + sign * other.values[right++];
+                }
+                if (value != 0.) {
+                    result.indices.push_back(col);
+                    result.values.push_back(value);
+                }
+            }
+            result.offsets[i + 1] = result.values.size();
+        }
+        return result;
+    }
+
+    CsrMatrix CsrMatrix::operator+(const CsrMatrix& add) const {
+        return merged(add, 1.);
+    }
+
+    CsrMatrix CsrMatrix::operator-(const CsrMatrix& diff) const {
+        return merged(diff, -1.);
+    }
+
+    // Counting sort by column: walking the rows in order keeps every output row sorted.
+    CsrMatrix CsrMatrix::transposed() const {
+        CsrMatrix result(cols, rows);
+        result.indices.resize(values.size());
+        result.values.resize(values.size());
+        for (size_t k = 0; k < values.size(); ++k)
+            ++result.offsets[indices[k] + 1];
+        std::partial_sum(result.offsets.begin(), result.offsets.end(), result.offsets.begin());
+        std::vector<size_t> next(result.offsets.begin(), result.offsets.end() - 1);
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                const size_t position = next[indices[k]]++;
+                result.indices[position] = i;
+                result.values[position] = values[k];
+            }
+        return result;
+    }
+
+    bool CsrMatrix::operator==(const CsrMatrix& other) const {
+        if (other.rows != rows || other.cols != cols)
+            return false;
+        const CsrMatrix difference = merged(other, -1.);
+        return std::all_of(difference.values.begin(), difference.values.end(), [](double value) {
+            return std::fabs(value) <= EPS;
+        });
+    }
+
+    bool CsrMatrix::operator!=(const CsrMatrix& other) const {
+        return !(*this == other);
+    }
+
+    CscMatrix::CscMatrix() {}
+
+    CscMatrix::CscMatrix(const size_t& rows, const size_t& cols) : columns(cols, rows) {}
+
+    CscMatrix::CscMatrix(const Matrix& matrix) : columns(CsrMatrix(matrix).transposed()) {}
+
+    CscMatrix::CscMatrix(const CsrMatrix& matrix) : columns(matrix.transposed()) {}
+
+    CscMatrix::CscMatrix(const size_t& rows, const size_t& cols, std::vector<Triplet> entries) {
+        for (Triplet& entry : entries)
+            std::swap(entry.row, entry.col);
+        columns = CsrMatrix(cols, rows, std::move(entries));
+    }
+
+    CscMatrix CscMatrix::ofTranspose(CsrMatrix&& transpose) {
+        CscMatrix result;
+        result.columns = std::move(transpose);
+        return result;
+    }
+
+    size_t CscMatrix::getRowsCount() const {
+        return columns.getColumnsCount();
+    }
+
+    size_t CscMatrix::getColumnsCount() const {
+        return columns.getRowsCount();
+    }
+
+    size_t CscMatrix::getNonZerosCount() const {
+        return columns.getNonZerosCount();
+    }
+
+    double CscMatrix::get(const size_t& row, const size_t& col) const {
+        return columns.get(col, row);
+    }
+
+    const std::vector<size_t>& CscMatrix::getOffsets() const {
+        return columns.getOffsets();
+    }
+
+    const std::vector<size_t>& CscMatrix::getIndices() const {
+        return columns.getIndices();
+    }
+
+    const std::vector<double>& CscMatrix::getValues() const {
+        return columns.getValues();
+    }
+
+    Matrix CscMatrix::toMatrix() const {
+        const std::vector<size_t>& offsets = getOffsets();
+        const std::vector<size_t>& indices = getIndices();
+        const std::vector<double>& values = getValues();
+        Matrix result = Matrix::zeros(getRowsCount(), getColumnsCount());
+        for (size_t j = 0; j < getColumnsCount(); ++j)
+            for (size_t k = offsets[j]; k < offsets[j + 1]; ++k)
+                result.set(indices[k], j, values[k]);
+        return result;
+    }
+
+    CsrMatrix CscMatrix::toCsr() const {
+        return columns.transposed();
+    }
+
+    std::vector<double> CscMatrix::operator*(const std::vector<double>& vector) const {
+        if (vector.size() != getColumnsCount())
+            throw SizeMismatchException();
+        const std::vector<size_t>& offsets = getOffsets();
+        const std::vector<size_t>& indices = getIndices();
+        const std::vector<double>& values = getValues();
+        std::vector<double> result(getRowsCount(), 0.);
+        for (size_t j = 0; j < getColumnsCount(); ++j) {
+            if (vector[j] == 0.)
+                continue;
+            for (size_t k = offsets[j]; k < offsets[j + 1]; ++k)
+                result[indices[k]] += values[k] * vector[j];
+        }
+        return result;
+    }
+
+    Matrix CscMatrix::operator*(const Matrix& mult) const {
+        if (mult.getRowsCount() != getColumnsCount())
+            throw SizeMismatchException();
+        const std::vector<size_t>& offsets = getOffsets();
+        const std::vector<size_t>& indices = getIndices();
+        const std::vector<double>& values = getValues();
+        const size_t width = mult.getColumnsCount();
+        Matrix result = Matrix::zeros(getRowsCount(), width);
+        if (width == 0)
+            return result;
+        // Every task owns a band of result columns, so the scattered updates never collide.
+        parallel::forRange(width, getNonZerosCount() + 1, [&](size_t begin, size_t end) {
+            for (size_t j = 0; j < getColumnsCount(); ++j) {
+                const double* in = mult.getRowView(j).begin();
+                for (size_t k = offsets[j]; k < offsets[j + 1]; ++k) {
+                    double* out = &result.get(indices[k], 0);
+                    for (size_t c = begin; c < end; ++c)
+                        out[c] += values[k] * in[c];
+                }
+            }
+        });
+        return result;
+    }
+
+    CscMatrix CscMatrix::operator+(const CscMatrix& add) const {
+        return ofTranspose(columns + add.columns);
+    }
+
+    CscMatrix CscMatrix::operator-(const CscMatrix& diff) const {
+        return ofTranspose(columns - diff.columns);
+    }
+
+    CscMatrix CscMatrix::transposed() const {
+        return ofTranspose(columns.transposed());
+    }
+
+    bool CscMatrix::operator==(const CscMatrix& other) const {
+        return columns == other.columns;
+    }
+
+    bool CscMatrix::operator!=(const CscMatrix& other) const {
+        return !(*this == other);
+    }
+
+    std::ostream& operator<<(std::ostream& out, const CsrMatrix& matrix) {
+        const std::vector<size_t>& offsets = matrix.getOffsets();
+        out << matrix.getRowsCount() << ' ' << matrix.getColumnsCount() << ' ' << matrix.getNonZerosCount() << '\n';
+        for (size_t i = 0; i < matrix.getRowsCount(); ++i)
+            for (size_t k = offsets[i]; k < offsets[i + 1]; ++k)
+                out << i << ' ' << matrix.getIndices()[k] << ' ' << matrix.getValues()[k] << '\n';
+        return out;
+    }
+
+    std::istream& operator>>(std::istream& in, CsrMatrix& matrix) {
+        if (!isCooInput(in)) {
+            Matrix dense;
+            if (in >> dense)
+                matrix = CsrMatrix(dense);
+            return in;
+        }
+        size_t rows, cols;
+        std::vector<Triplet> entries;
+        if (readCoordinates(in, rows, cols, entries))
+            matrix = CsrMatrix(rows, cols, std::move(entries));
+        return in;
+    }
+
+    std::ostream& operator<<(std::ostream& out, const CscMatrix& matrix) {
+        const std::vector<size_t>& offsets = matrix.getOffsets();
+        out << matrix.getRowsCount() << ' ' << matrix.getColumnsCount() << ' ' << matrix.getNonZerosCount() << '\n';
+        for (size_t j = 0; j < matrix.getColumnsCount(); ++j)
+            for (size_t k = offsets[j]; k < offsets[j + 1]; ++k)
+                out << matrix.getIndices()[k] << ' ' << j << ' ' << matrix.getValues()[k] << '\n';
+        return out;
+    }
+
+    std::istream& operator>>(std::istream& in, CscMatrix& matrix) {
+        if (!isCooInput(in)) {
+            Matrix dense;
+            if (in >> dense)
+                matrix = CscMatrix(dense);
+            return in;
+        }
+        size_t rows, cols;
+        std::vector<Triplet> entries;
+        if (readCoordinates(in, rows, cols, entries))
+            matrix = CscMatrix(rows, cols, std::move(entries));
+        return in;
+    }
+
+}  // namespace task
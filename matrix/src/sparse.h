@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include "matrix.h"
+
+namespace task {
+
+    class CscMatrix;
+
+    // Compressed sparse row matrix. The nonzeros of row i are values[offsets[i] .. offsets[i + 1])
+    // and their columns are stored at the same positions of `indices`, sorted ascending.
+    // Explicit zeros are never stored. A fresh sparse matrix is all zeros, not identity-like.
+    class CsrMatrix {
+    private:
+        size_t rows, cols;
+        std::vector<size_t> offsets;
+        std::vector<size_t> indices;
+        std::vector<double> values;
+
+        CsrMatrix merged(const CsrMatrix&, const double&) const;
+
+    public:
+
+        CsrMatrix();
+        explicit CsrMatrix(const size_t&, const size_t&);
+        explicit CsrMatrix(const Matrix&);
+        explicit CsrMatrix(const CscMatrix&);
+        // Entries may come in any order; duplicates are summed.
+        CsrMatrix(const size_t&, const size_t&, std::vector<Triplet>);
+
+        size_t getRowsCount() const;
+        size_t getColumnsCount() const;
+        size_t getNonZerosCount() const;
+
+        double get(const size_t&, const size_t&) const;
+
+        const std::vector<size_t>& getOffsets() const;
+        const std::vector<size_t>& getIndices() const;
+        const std::vector<double>& getValues() const;
+
+        Matrix toMatrix() const;
+        CscMatrix toCsc() const;
+
+        // SpMV and SpMM; rows are split across parallel::getThreadsCount() threads.
+        std::vector<double> operator*(const std::vector<double>&) const;
+        Matrix operator*(const Matrix&) const;
+
+        CsrMatrix operator+(const CsrMatrix&) const;
+        CsrMatrix operator-(const CsrMatrix&) const;
+
+        CsrMatrix transposed() const;
+
+        bool operator==(const CsrMatrix&) const;
+        bool operator!=(const CsrMatrix&) const;
+
+    };
+
+    // Compressed sparse column matrix. Its arrays are exactly those of its transpose in CSR,
+    // so it is stored as one: column j of this matrix is row j of `columns`.
+    class CscMatrix {
+    private:
+        CsrMatrix columns;
+
+        static CscMatrix ofTranspose(CsrMatrix&&);
+
+    public:
+
+        CscMatrix();
+        explicit CscMatrix(const size_t&, const size_t&);
+        explicit CscMatrix(const Matrix&);
+        explicit CscMatrix(const CsrMatrix&);
+        // Entries may come in any order; duplicates are summed.
+        CscMatrix(const size_t&, const size_t&, std::vector<Triplet>);
+
+        size_t getRowsCount() const;
+        size_t getColumnsCount() const;
+        size_t getNonZerosCount() const;
+
+        double get(const size_t&, const size_t&) const;
+
+        const std::vector<size_t>& getOffsets() const;
+        const std::vector<size_t>& getIndices() const;
+        const std::vector<double>& getValues() const;
+
+        Matrix toMatrix() const;
+        CsrMatrix toCsr() const;
+
+        // SpMV scatters into the result column by column and runs sequentially;
+        // SpMM splits the columns of the dense operand across threads.
+        std::vector<double> operator*(const std::vector<double>&) const;
+        Matrix operator*(const Matrix&) const;
+
+        CscMatrix operator+(const CscMatrix&) const;
+        CscMatrix operator-(const CscMatrix&) const;
+
+        CscMatrix transposed() const;
+
+        bool operator==(const CscMatrix&) const;
+        bool operator!=(const CscMatrix&) const;
+
+    };
+
+    // Output is always COO ("rows cols count" and one "row col value" line per nonzero);
+    // input follows the dense / coo manipulators, like Matrix.
+    std::ostream& operator<<(std::ostream&, const CsrMatrix&);
+    std::istream& operator>>(std::istream&, CsrMatrix&);
+    std::ostream& operator<<(std::ostream&, const CscMatrix&);
+    std::istream& operator>>(std::istream&, CscMatrix&);
+
+}  // namespace task
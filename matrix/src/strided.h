@@ -0,0 +1,251 @@
+#pragma once
+
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace task {
+
+    // Algorithms on a row-major block of rows x cols elements whose rows are `stride` apart,
+    // written once for any arithmetic T and shared by Matrix, BasicMatrix<T> and FixedMatrix.
+    // Matrix keeps its SIMD and BLIS kernels for the elementwise operations and products on
+    // doubles; everything else goes through here. The loops used by FixedMatrix are constexpr.
+    namespace strided {
+
+        template<class T>
+        constexpr T magnitude(T value) {
+            return value < 0 ? -value : value;
+        }
+
+        // Within `eps` for floating-point T, equal for integral T.
+        template<class T>
+        constexpr bool close(T left, T right, double eps) {
+            if constexpr (std::is_floating_point<T>::value)
+                return magnitude(left - right) <= eps;
+            else
+                return left == right;
+        }
+
+        template<class T>
+        constexpr void swapRows(T* data, size_t stride, size_t cols, size_t first, size_t second) {
+            for (size_t j = 0; j < cols; ++j) {
+                T buffer = data[first * stride + j];
+                data[first * stride + j] = data[second * stride + j];
+                data[second * stride + j] = buffer;
+            }
+        }
+
+        // Gaussian elimination with partial pivoting; overwrites the size x size block.
+        template<class T>
+        constexpr T pivotedDet(T* data, size_t stride, size_t size) {
+            T result = 1;
+            bool negate = false;
+            for (size_t k = 0; k < size; ++k) {
+                size_t pivot = k;
+                for (size_t i = k + 1; i < size; ++i)
+                    if (magnitude(data[i * stride + k]) > magnitude(data[pivot * stride + k]))
+                        pivot = i;
+                if (data[pivot * stride + k] == 0)
+                    return 0;
+                if (pivot != k) {
+                    swapRows(data, stride, size, k, pivot);
+                    negate = !negate;
+                }
+                const T* pivotRow = data + k * stride;
+                for (size_t i = k + 1; i < size; ++i) {
+                    T* row = data + i * stride;
+                    const T factor = row[k] / pivotRow[k];
+                    for (size_t j = k + 1; j < size; ++j)
+                        row[j] -= factor * pivotRow[j];
+                }
+                result *= pivotRow[k];
+            }
+            return negate ? -result : result;
+        }
+
+        // Fraction-free Bareiss elimination; overwrites the size x size block. Exact for integers,
+        // integral T or integer-valued floating-point ones, as long as products of two minors fit.
+        template<class T>
+        constexpr T bareissDet(T* data, size_t stride, size_t size) {
+            T previous = 1;
+            bool negate = false;
+            for (size_t k = 0; k + 1 < size; ++k) {
+                if (data[k * stride + k] == 0) {
+                    size_t pivot = k + 1;
+                    while (pivot < size && data[pivot * stride + k] == 0)
+                        ++pivot;
+                    if (pivot == size)
+                        return 0;
+                    swapRows(data, stride, size, k, pivot);
+                    negate = !negate;
+                }
+                const T* pivotRow = data + k * stride;
+                for (size_t i = k + 1; i < size; ++i) {
+                    T* row = data + i * stride;
+                    for (size_t j = k + 1; j < size; ++j)
+                        row[j] = (row[j] * pivotRow[k] - row[k] * pivotRow[j]) / previous;
+                }
+                previous = pivotRow[k];
+            }
+            const T result = data[(size - 1) * stride + size - 1];
+            return negate ? -result : result;
+        }
+
+        // pivotedDet for floating-point T, bareissDet for integral T.
+        template<class T>
+        constexpr T det(T* data, size_t stride, size_t size) {
+            if constexpr (std::is_floating_point<T>::value)
+                return pivotedDet(data, stride, size);
+            else
+                return bareissDet(data, stride, size);
+        }
+
+        template<class T>
+        constexpr T trace(const T* data, size_t stride, size_t size) {
+            T result = 0;
+            for (size_t i = 0; i < size; ++i)
+                result += data[i * stride + i];
+            return result;
+        }
+
+        // out = op(in) elementwise; out may be in.
+        template<class T, class Op>
+        void apply(const T* in, size_t inStride, T* out, size_t outStride, size_t rows, size_t cols, Op op) {
+            for (size_t i = 0; i < rows; ++i)
+                for (size_t j = 0; j < cols; ++j)
+                    out[i * outStride + j] = op(in[i * inStride + j]);
+        }
+
+        // out = op(left, right) elementwise; out may be either operand.
+        template<class T, class Op>
+        void combine(const T* left, size_t leftStride, const T* right, size_t rightStride,
+                     T* out, size_t outStride, size_t rows, size_t cols, Op op) {
+            for (size_t i = 0; i < rows; ++i)
+                for (size_t j = 0; j < cols; ++j)
+                    out[i * outStride + j] = op(left[i * leftStride + j], right[i * rightStride + j]);
+        }
+
+        // C = A * B for A (m x k), B (k x n) and C (m x n), in i-k-j order so that the inner loop
+        // streams rows of both B and C.
+        template<class T>
+        void multiply(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc) {
+            for (size_t i = 0; i < m; ++i) {
+                T* out = c + i * ldc;
+                for (size_t j = 0; j < n; ++j)
+                    out[j] = 0;
+                for (size_t l = 0; l < k; ++l) {
+                    const T factor = a[i * lda + l];
+                    const T* in = b + l * ldb;
+                    for (size_t j = 0; j < n; ++j)
+                        out[j] += factor * in[j];
+                }
+            }
+        }
+
+        // out (cols x rows) = in (rows x cols) transposed.
+        template<class T>
+        void transpose(const T* in, size_t inStride, T* out, size_t outStride, size_t rows, size_t cols) {
+            for (size_t i = 0; i < rows; ++i)
+                for (size_t j = 0; j < cols; ++j)
+                    out[j * outStride + i] = in[i * inStride + j];
+        }
+
+        template<class T>
+        constexpr bool equal(const T* left, size_t leftStride, const T* right, size_t rightStride,
+                   size_t rows, size_t cols, double eps) {
+            for (size_t i = 0; i < rows; ++i)
+                for (size_t j = 0; j < cols; ++j)
+                    if (!close(left[i * leftStride + j], right[i * rightStride + j], eps))
+                        return false;
+            return true;
+        }
+
+        template<class T>
+        std::vector<T> column(const T* data, size_t stride, size_t rows, size_t col) {
+            std::vector<T> result;
+            result.reserve(rows);
+            for (size_t i = 0; i < rows; ++i)
+                result.push_back(data[i * stride + col]);
+            return result;
+        }
+
+        // Reads one whitespace-separated token straight from the stream buffer and converts it
+        // with std::from_chars, skipping the sentry and locale work of istream extraction.
+        // Tokens live on the stack; the rare one longer than that (a numeral with hundreds of
+        // digits) spills into a string.
+        template<class T>
+        bool readNumber(std::streambuf& buffer, T& value) {
+            typedef std::char_traits<char> traits;
+            char token[128];
+            std::string longToken;
+            size_t length = 0;
+            traits::int_type symbol = buffer.sgetc();
+            while (!traits::eq_int_type(symbol, traits::eof()) && std::isspace(symbol))
+                symbol = buffer.snextc();
+            while (!traits::eq_int_type(symbol, traits::eof()) && !std::isspace(symbol)) {
+                if (length == sizeof(token)) {
+                    longToken.append(token, length);
+                    length = 0;
+                }
+                token[length++] = traits::to_char_type(symbol);
+                symbol = buffer.snextc();
+            }
+            const char* first = token;
+            const char* last = token + length;
+            if (!longToken.empty()) {
+                longToken.append(token, length);
+                first = longToken.data();
+                last = first + longToken.size();
+            }
+            if (last - first > 1 && first[0] == '+' && first[1] != '-')
+                ++first;
+            auto result = std::from_chars(first, last, value);
+            return first != last && result.ec == std::errc() && result.ptr == last;
+        }
+
+        // The dense text format: rows, cols and then the values in row-major order. `matrix`
+        // is any matrix type with resize(), getData() and getStride(); on malformed input the
+        // stream gets failbit and the matrix is left partially read.
+        template<class M>
+        std::istream& read(std::istream& in, M& matrix) {
+            std::istream::sentry sentry(in);
+            if (!sentry)
+                return in;
+            std::streambuf& buffer = *in.rdbuf();
+            size_t rows, cols;
+            if (!readNumber(buffer, rows) || !readNumber(buffer, cols)) {
+                in.setstate(std::ios_base::failbit);
+                return in;
+            }
+            matrix.resize(rows, cols);
+            for (size_t i = 0; i < rows; ++i) {
+                auto* row = matrix.getData() + i * matrix.getStride();
+                for (size_t j = 0; j < cols; ++j)
+                    if (!readNumber(buffer, row[j])) {
+                        in.setstate(std::ios_base::failbit);
+                        return in;
+                    }
+            }
+            if (std::char_traits<char>::eq_int_type(buffer.sgetc(), std::char_traits<char>::eof()))
+                in.setstate(std::ios_base::eofbit);
+            return in;
+        }
+
+        // The values only, one row per line, each followed by a space.
+        template<class T>
+        std::ostream& write(std::ostream& out, const T* data, size_t stride, size_t rows, size_t cols) {
+            for (size_t i = 0; i < rows; ++i) {
+                for (size_t j = 0; j < cols; ++j)
+                    out << data[i * stride + j] << ' ';
+                out << '\n';
+            }
+            return out;
+        }
+
+    }  // namespace strided
+
+}  // namespace task
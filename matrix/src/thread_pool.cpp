@@ -0,0 +1,155 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace task {
+
+    namespace {
+
+        thread_local bool insideChunk = false;
+
+    }  // namespace
+
+    ThreadPool::ThreadPool(size_t threads)
+        : job(nullptr), chunks(0), nextChunk(0), busyWorkers(0), generation(0), stopping(false) {
+        for (size_t i = 1; i < threads; ++i)
+            workers.emplace_back(&ThreadPool::work, this);
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    size_t ThreadPool::getThreadsCount() const {
+        return workers.size() + 1;
+    }
+
+    void ThreadPool::runChunks(std::unique_lock<std::mutex>& lock) {
+        while (nextChunk < chunks) {
+            size_t chunk = nextChunk++;
+            const std::function<void(size_t)>& body = *job;
+            lock.unlock();
+            insideChunk = true;
+            try {
+                body(chunk);
+            } catch (...) {
+                lock.lock();
+                if (!error)
+                    error = std::current_exception();
+                nextChunk = chunks;
+                lock.unlock();
+            }
+            insideChunk = false;
+            lock.lock();
+        }
+    }
+
+    void ThreadPool::work() {
+        size_t seen = 0;
+        std::unique_lock<std::mutex> lock(stateMutex);
+        while (true) {
+            wakeUp.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            ++busyWorkers;
+            runChunks(lock);
+            if (--busyWorkers == 0)
+                finished.notify_all();
+        }
+    }
+
+    void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+        if (workers.empty() || count <= 1 || insideChunk) {
+            for (size_t i = 0; i < count; ++i)
+                body(i);
+            return;
+        }
+        std::lock_guard<std::mutex> submit(submitMutex);
+        std::unique_lock<std::mutex> lock(stateMutex);
+        job = &body;
+        chunks = count;
+        nextChunk = 0;
+        error = nullptr;
+        ++generation;
+        wakeUp.notify_all();
+        runChunks(lock);
+        finished.wait(lock, [&] { return busyWorkers == 0; });
+        job = nullptr;
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    namespace parallel {
+
+        namespace {
+
+            std::atomic<size_t> threadsCount{1};
+            std::atomic<size_t> grainSize{1 << 16};
+
+            // Operations copy the pointer under poolMutex, so replacing the pool never frees one
+            // that is still in use: the old one goes away with its last operation.
+            std::mutex poolMutex;
+            std::shared_ptr<ThreadPool> pool;
+
+            std::shared_ptr<ThreadPool> acquirePool(size_t threads) {
+                std::lock_guard<std::mutex> lock(poolMutex);
+                if (!pool || pool->getThreadsCount() != threads)
+                    pool = std::make_shared<ThreadPool>(threads);
+                return pool;
+            }
+
+        }  // namespace
+
+        void setThreadsCount(size_t threads) {
+            if (threads == 0)
+                threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+            if (threadsCount.exchange(threads) == threads)
+                return;
+            std::shared_ptr<ThreadPool> old;  // joined after the lock is released
+            {
+                std::lock_guard<std::mutex> lock(poolMutex);
+                old.swap(pool);
+            }
+        }
+
+        size_t getThreadsCount() {
+            return threadsCount;
+        }
+
+        void setGrainSize(size_t grain) {
+            grainSize = std::max<size_t>(1, grain);
+        }
+
+        size_t getGrainSize() {
+            return grainSize;
+        }
+
+        void forRange(size_t count, size_t cost, const std::function<void(size_t, size_t)>& body) {
+            if (count == 0)
+                return;
+            const size_t threads = threadsCount;
+            const size_t itemsPerTask = std::max<size_t>(1, grainSize / std::max<size_t>(1, cost));
+            size_t tasks = std::min(threads * 4, (count + itemsPerTask - 1) / itemsPerTask);
+            if (threads == 1 || tasks <= 1) {
+                body(0, count);
+                return;
+            }
+            const std::shared_ptr<ThreadPool> workers = acquirePool(threads);
+            const size_t step = (count + tasks - 1) / tasks;
+            tasks = (count + step - 1) / step;
+            workers->parallelFor(tasks, [&](size_t index) {
+                body(index * step, std::min(count, (index + 1) * step));
+            });
+        }
+
+    }  // namespace parallel
+
+}  // namespace task
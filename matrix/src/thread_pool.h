@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace task {
+
+    // Fork-join pool: parallelFor hands chunk indices to the workers and the calling thread
+    // and returns once every chunk is done. Calls made from inside a chunk run inline.
+    class ThreadPool {
+    private:
+        std::vector<std::thread> workers;
+
+        std::mutex submitMutex;
+        std::mutex stateMutex;
+        std::condition_variable wakeUp;
+        std::condition_variable finished;
+
+        const std::function<void(size_t)>* job;
+        size_t chunks;
+        size_t nextChunk;
+        size_t busyWorkers;
+        size_t generation;
+        bool stopping;
+        std::exception_ptr error;
+
+        void work();
+        void runChunks(std::unique_lock<std::mutex>&);
+
+    public:
+        explicit ThreadPool(size_t);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t getThreadsCount() const;
+        void parallelFor(size_t, const std::function<void(size_t)>&);
+    };
+
+    namespace parallel {
+
+        // Number of threads used by Matrix operations, including the caller; 1 runs everything
+        // sequentially (the default), 0 picks std::thread::hardware_concurrency(). The settings
+        // may change while operations run on other threads; those finish with the old ones.
+        void setThreadsCount(size_t);
+        size_t getThreadsCount();
+
+        // Minimal amount of work (in multiply-adds or element updates) handed to one task.
+        void setGrainSize(size_t);
+        size_t getGrainSize();
+
+        // Runs body over contiguous subranges of [0, count) covering it exactly once,
+        // where every item costs roughly `cost` units of work.
+        void forRange(size_t count, size_t cost, const std::function<void(size_t, size_t)>& body);
+
+    }  // namespace parallel
+
+}  // namespace task
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include "expression.h"
+
+namespace task {
+
+    // Non-owning, read-only window into a Matrix. Bounds are checked when the view is taken
+    // from the matrix, element access is unchecked. A view is an expression leaf, so it can be
+    // combined with matrices, other views and lazy expressions, and assigned to a Matrix.
+    // It is invalidated by anything that reallocates the matrix it points into.
+    class SubMatrixView : public MatrixExpression<SubMatrixView> {
+    protected:
+        const double* data;
+        size_t rows, cols;
+        size_t rowStride, colStride;
+
+    public:
+        SubMatrixView(const double* data, size_t rows, size_t cols, size_t rowStride, size_t colStride = 1)
+            : data(data), rows(rows), cols(cols), rowStride(rowStride), colStride(colStride) {}
+
+        size_t getRowsCount() const { return rows; }
+        size_t getColumnsCount() const { return cols; }
+
+        double operator()(size_t row, size_t col) const { return data[row * rowStride + col * colStride]; }
+    };
+
+    class RowView : public SubMatrixView {
+    public:
+        RowView(const double* data, size_t cols) : SubMatrixView(data, 1, cols, cols) {}
+
+        size_t size() const { return cols; }
+
+        const double& operator[](size_t col) const { return data[col]; }
+        const double* begin() const { return data; }
+        const double* end() const { return data + cols; }
+    };
+
+    class ColumnView : public SubMatrixView {
+    public:
+        ColumnView(const double* data, size_t rows, size_t stride) : SubMatrixView(data, rows, 1, stride) {}
+
+        size_t size() const { return rows; }
+
+        const double& operator[](size_t row) const { return data[row * rowStride]; }
+    };
+
+}  // namespace task
@@ -3,8 +3,20 @@
 #include <random>
 #include <algorithm>
 #include <sstream>
+#include <fstream>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <thread>
 #include "src/matrix.h"
+#include "src/batch.h"
+#include "src/fixed_matrix.h"
+#include "src/gemm.h"
+#include "src/matrix_io.h"
+#include "src/simd.h"
+#include "src/sparse.h"
+#include "src/thread_pool.h"
 
 
 using task::Matrix;
@@ -44,6 +56,14 @@ Matrix RandomMatrix(size_t rows, size_t cols) {
 }
 
 
+// Serves a string like a pipe: no seeking, so tellg() fails.
+struct ForwardOnlyBuffer : std::streambuf {
+    explicit ForwardOnlyBuffer(std::string& text) {
+        setg(text.data(), text.data(), text.data() + text.size());
+    }
+};
+
+
 void FailWithMsg(const std::string& msg, int line) {
     std::cerr << "Test failed!\n";
     std::cerr << "[Line " << line << "] "  << msg << std::endl;
@@ -108,6 +128,9 @@ int main(int argc, char** argv) {
         ASSERT_EXCEPTION_MSG(mat.get(1, 0), task::OutOfBoundsException, "get()")
         ASSERT_EXCEPTION_MSG(mat.set(0, 1, 10.), task::OutOfBoundsException, "set()")
 
+        ASSERT_TRUE_MSG(&mat2.uncheckedAt(1, 1) == mat2.getData() + mat2.getStride() + 1, "uncheckedAt()")
+        ASSERT_TRUE_MSG(mat_c.uncheckedAt(1, 0) == 200., "uncheckedAt()")
+        ASSERT_EXCEPTION_MSG(mat1[0][2], task::OutOfBoundsException, "Operator []")
         ASSERT_EXCEPTION_MSG(mat_c.get(2, 0), task::OutOfBoundsException, "get()")
         ASSERT_EXCEPTION_MSG(mat2.set(0, 2, 10.), std::exception, "set()")
 
@@ -127,6 +150,11 @@ int main(int argc, char** argv) {
         }
         */
 
+        Matrix moved = std::move(mat2);
+        ASSERT_TRUE_MSG(moved.get(0, 1) == 100. && moved.getRowsCount() == 2, "Move constructor")
+        mat2 = std::move(moved);
+        ASSERT_TRUE_MSG(mat2.get(0, 1) == 100. && mat2.getColumnsCount() == 2, "Move assignment")
+
         auto mat3 = RandomMatrix(1000, 1000);
         for (size_t i = 0; i < 1000; ++i) {
             auto row = mat3.getRow(i);
@@ -137,6 +165,25 @@ int main(int argc, char** argv) {
             }
         }
 
+
+        auto mat4 = RandomMatrix(30, 20);
+        auto rowView = mat4.getRowView(7);
+        auto columnView = mat4.getColumnView(5);
+        ASSERT_TRUE_MSG(rowView.size() == 20 && columnView.size() == 30, "Row / column views")
+        ASSERT_TRUE_MSG(mat4.getColumn(5).size() == 30, "getColumn()")
+        for (size_t i = 0; i < 30; ++i)
+            ASSERT_TRUE_MSG(columnView[i] == mat4.get(i, 5), "Column view")
+        for (size_t j = 0; j < 20; ++j)
+            ASSERT_TRUE_MSG(rowView[j] == mat4.get(7, j), "Row view")
+
+        Matrix block = mat4.getSubMatrixView(10, 4, 3, 5) + mat4.getSubMatrixView(0, 0, 3, 5);
+        for (size_t i = 0; i < 3; ++i)
+            for (size_t j = 0; j < 5; ++j)
+                ASSERT_TRUE_MSG(block.get(i, j) == mat4.get(10 + i, 4 + j) + mat4.get(i, j), "Submatrix view")
+        Matrix column = mat4.getColumnView(0) - task::lazy(Matrix(mat4.getColumnView(0)));
+        ASSERT_TRUE_MSG(column == Matrix(30, 1) * 0., "Column view arithmetic")
+        ASSERT_EXCEPTION_MSG(mat4.getSubMatrixView(28, 0, 3, 1), task::OutOfBoundsException, "Submatrix view")
+        ASSERT_EXCEPTION_MSG(mat4.getColumnView(20), task::OutOfBoundsException, "Column view")
     }
 
     REPEAT(10)
@@ -170,6 +217,223 @@ int main(int argc, char** argv) {
         ASSERT_EXCEPTION_MSG(mat1.trace(), task::SizeMismatchException, "Exceptions");
     }
 
+    REPEAT(3)
+    {
+        size_t n = RandomUInt(60, 300), k = RandomUInt(60, 300), m = RandomUInt(60, 300);
+        auto mat1 = RandomMatrix(n, k);
+        auto mat2 = RandomMatrix(k, m);
+        auto res = mat1 * mat2;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < m; ++j) {
+                double expected = 0;
+                for (size_t l = 0; l < k; ++l)
+                    expected += mat1.get(i, l) * mat2.get(l, j);
+                ASSERT_TRUE_MSG(fabs(res.get(i, j) - expected) < EPS * 10., "Blocked operator *")
+            }
+        }
+    }
+
+    REPEAT(10)
+    {
+        size_t n = RandomUInt(5, 60);
+        Matrix lower(n, n), upper(n, n);
+        double expected = 1;
+        for (size_t i = 0; i < n; ++i) {
+            upper[i][i] = TossCoin() ? 1.25 : -0.8;
+            expected *= upper[i][i];
+            for (size_t j = 0; j < i; ++j) {
+                lower[i][j] = RandomDouble() / 10.;
+                upper[j][i] = RandomDouble() / 10.;
+            }
+        }
+        auto mat = lower * upper;
+        ASSERT_TRUE_MSG(fabs(mat.det() - expected) < EPS * fabs(expected), "LU determinant")
+
+        auto rhs = RandomMatrix(n, RandomUInt(1, 5));
+        auto solution = mat.lu().solve(rhs);
+        ASSERT_TRUE_MSG(mat * solution == rhs, "LU solve")
+
+        Matrix integral(5, 5);
+        for (size_t i = 0; i < 5; ++i)
+            for (size_t j = 0; j < 5; ++j)
+                integral[i][j] = static_cast<double>(RandomUInt(0, 20)) - 10.;
+        ASSERT_TRUE_MSG(fabs(integral.bareissDet() - integral.lu().det()) < EPS * 1e3, "Bareiss determinant")
+    }
+
+    REPEAT(5)
+    {
+        size_t n = RandomUInt(65, 200);
+        auto mat = RandomMatrix(n, n);
+        for (size_t i = 0; i < n; ++i)
+            mat[i][i] += 100.;
+        auto rhs = RandomMatrix(n, RandomUInt(1, 5));
+        ASSERT_TRUE_MSG(mat * mat.solve(rhs) == rhs, "Blocked LU solve()")
+        ASSERT_TRUE_MSG(mat * mat.inverse() == Matrix(n, n), "inverse()")
+        ASSERT_EXCEPTION_MSG(Matrix(n, n + 1).solve(rhs), task::SizeMismatchException, "solve()")
+        ASSERT_EXCEPTION_MSG(Matrix(2, 2).solve(Matrix(3, 1)), task::SizeMismatchException, "solve()")
+        Matrix singular(2, 2);
+        singular[1][1] = 0.;
+        ASSERT_EXCEPTION_MSG(singular.inverse(), task::SingularMatrixException, "inverse()")
+
+        auto spd = mat * mat.transposed();
+        auto cholesky = spd.cholesky();
+        const auto& l = cholesky.getL();
+        ASSERT_TRUE_MSG(l * l.transposed() == spd, "Cholesky L L^T")
+        ASSERT_TRUE_MSG(l[0][n - 1] == 0., "Cholesky L is lower triangular")
+        ASSERT_TRUE_MSG(spd * cholesky.solve(rhs) == rhs, "Cholesky solve()")
+        auto scaled = spd * 1e-4;
+        ASSERT_TRUE_MSG(fabs(scaled.cholesky().det() / scaled.det() - 1.) < EPS, "Cholesky det()")
+        ASSERT_EXCEPTION_MSG((-spd).cholesky(), task::NotPositiveDefiniteException, "Cholesky of a non-SPD matrix")
+
+        size_t rows = RandomUInt(n, n + 50), cols = RandomUInt(1, n);
+        auto tall = RandomMatrix(rows, cols);
+        auto qr = tall.qr();
+        auto q = qr.getQ(), r = qr.getR();
+        Matrix permuted(rows, cols);
+        for (size_t j = 0; j < cols; ++j)
+            for (size_t i = 0; i < rows; ++i)
+                permuted[i][j] = tall[i][qr.getPermutation()[j]];
+        ASSERT_TRUE_MSG(q * r == permuted, "QR AP = QR")
+        ASSERT_TRUE_MSG(q.transposed() * q == Matrix(cols, cols), "QR Q is orthonormal")
+        ASSERT_TRUE_MSG(tall.rank() == cols, "rank()")
+
+        auto b = RandomMatrix(rows, 2);
+        auto x = qr.solve(b);
+        auto normal = tall.transposed() * (tall * x - b);
+        ASSERT_TRUE_MSG(normal == Matrix(cols, 2) - Matrix(cols, 2), "QR least squares")
+
+        auto dependent = RandomMatrix(rows, 3) * RandomMatrix(3, cols + 3);
+        ASSERT_TRUE_MSG(dependent.rank() == 3, "rank() of a rank-deficient matrix")
+        ASSERT_TRUE_MSG(Matrix(4, 6).rank() == 4, "rank()")
+    }
+
+    REPEAT(10)
+    {
+        size_t n = RandomUInt(1, 150), m = RandomUInt(1, 150);
+        auto mat1 = RandomMatrix(n, m);
+        auto square = RandomMatrix(n, n);
+        auto transposed = mat1.transposed();
+        auto squareTransposed = square;
+        squareTransposed.transpose();
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < m; ++j)
+                ASSERT_TRUE_MSG(transposed.get(j, i) == mat1.get(i, j), "Blocked transposed()")
+            for (size_t j = 0; j < n; ++j)
+                ASSERT_TRUE_MSG(squareTransposed.get(j, i) == square.get(i, j), "In-place transpose()")
+        }
+    }
+
+    {
+        auto mat1 = RandomMatrix(150, 170);
+        auto mat2 = RandomMatrix(170, 150);
+        auto square = RandomMatrix(120, 120);
+        auto product = mat1 * mat2;
+        auto sum = mat1 + mat1 * 2.;
+        auto transposed = mat1.transposed();
+        double det = square.det();
+
+        task::parallel::setThreadsCount(4);
+        task::parallel::setGrainSize(1000);
+        ASSERT_TRUE_MSG(mat1 * mat2 == product, "Parallel operator *")
+        ASSERT_TRUE_MSG(mat1 + mat1 * 2. == sum, "Parallel elementwise operators")
+        ASSERT_TRUE_MSG(mat1.transposed() == transposed, "Parallel transposed()")
+        ASSERT_TRUE_MSG(fabs(square.det() - det) <= EPS * fabs(det), "Parallel det()")
+
+        // Operations from several user threads while the pool is resized under them.
+        std::vector<std::thread> users;
+        std::vector<int> correct(3, 1);
+        for (size_t user = 0; user < correct.size(); ++user)
+            users.emplace_back([&, user] {
+                REPEAT(20)
+                    correct[user] &= mat1 * mat2 == product && mat1.transposed() == transposed;
+            });
+        REPEAT(20) {
+            task::parallel::setThreadsCount(RandomUInt(2, 4));
+            task::parallel::setGrainSize(RandomUInt(100, 10000));
+        }
+        for (auto& user : users)
+            user.join();
+        ASSERT_TRUE_MSG(std::count(correct.begin(), correct.end(), 1) == 3, "Concurrent parallel operations")
+        task::parallel::setGrainSize(1 << 16);
+        task::parallel::setThreadsCount(1);
+    }
+
+    // The elementwise kernels of every instruction set the CPU supports, not just the widest.
+    for (const char* set : {"scalar", "sse2", "avx2", "avx512"}) {
+        if (!task::simd::useInstructionSet(set))
+            continue;
+        ASSERT_TRUE_MSG(std::string(task::simd::instructionSet()) == set, "useInstructionSet()")
+        const std::string name = std::string("SIMD kernels (") + set + ")";
+        REPEAT(20) {
+            // Odd lengths and offsets cover the unaligned heads and the scalar tails.
+            size_t n = RandomUInt(1, 70), offset = RandomUInt(0, 3);
+            std::vector<double> a(n + offset), b(n + offset), out(n + offset);
+            for (size_t i = 0; i < n + offset; ++i) {
+                a[i] = RandomDouble();
+                b[i] = RandomDouble();
+            }
+            const double* x = a.data() + offset;
+            const double* y = b.data() + offset;
+            double* z = out.data() + offset;
+            double number = RandomDouble();
+
+            task::simd::add(x, y, z, n);
+            for (size_t i = 0; i < n; ++i)
+                ASSERT_TRUE_MSG(z[i] == x[i] + y[i], name + " add")
+            task::simd::subtract(x, y, z, n);
+            for (size_t i = 0; i < n; ++i)
+                ASSERT_TRUE_MSG(z[i] == x[i] - y[i], name + " subtract")
+            task::simd::scale(x, number, z, n);
+            for (size_t i = 0; i < n; ++i)
+                ASSERT_TRUE_MSG(z[i] == x[i] * number, name + " scale")
+            task::simd::negate(x, z, n);
+            for (size_t i = 0; i < n; ++i)
+                ASSERT_TRUE_MSG(z[i] == -x[i], name + " negate")
+
+            std::copy(x, x + n, z);
+            ASSERT_TRUE_MSG(task::simd::equal(x, z, n, EPS), name + " equal")
+            size_t changed = RandomUInt(n - 1);
+            z[changed] += EPS / 2;
+            ASSERT_TRUE_MSG(task::simd::equal(x, z, n, EPS), name + " equal within EPS")
+            z[changed] += 2 * EPS;
+            ASSERT_TRUE_MSG(!task::simd::equal(x, z, n, EPS), name + " equal finds a mismatch")
+        }
+
+        auto mat1 = RandomMatrix(RandomUInt(1, 40), RandomUInt(1, 40));
+        auto mat2 = RandomMatrix(mat1.getRowsCount(), mat1.getColumnsCount());
+        Matrix sum = mat1, negated = -mat1, scaled = mat1;
+        sum += mat2;
+        scaled *= 3.;
+        sum -= mat2;
+        for (size_t i = 0; i < mat1.getRowsCount(); ++i)
+            for (size_t j = 0; j < mat1.getColumnsCount(); ++j)
+                ASSERT_TRUE_MSG(negated.get(i, j) == -mat1.get(i, j) && scaled.get(i, j) == mat1.get(i, j) * 3.,
+                                name + " Matrix operators")
+        ASSERT_TRUE_MSG(sum == mat1 && !(sum == scaled), name + " Matrix operators")
+    }
+    task::simd::useInstructionSet(nullptr);
+
+    REPEAT(10)
+    {
+        auto rows = RandomUInt(1, 100), cols = RandomUInt(1, 100);
+        auto mat1 = RandomMatrix(rows, cols);
+        auto mat2 = RandomMatrix(rows, cols);
+        auto mat3 = RandomMatrix(rows, cols);
+        double scalar = RandomDouble();
+
+        Matrix lazy = task::lazy(mat1) + task::lazy(mat2) * scalar - mat3;
+        ASSERT_TRUE_MSG(lazy == mat1 + mat2 * scalar - mat3, "Lazy expression")
+
+        lazy = -task::lazy(mat1) + 2. * (mat2 - task::lazy(mat3));
+        ASSERT_TRUE_MSG(lazy == -mat1 + 2. * (mat2 - mat3), "Lazy expression")
+
+        lazy += task::lazy(mat1);
+        lazy -= task::lazy(mat2) * 2.;
+        ASSERT_TRUE_MSG(lazy == mat3 * -2., "Lazy compound assignment")
+
+        ASSERT_EXCEPTION_MSG(task::lazy(mat1) + RandomMatrix(rows + 1, cols), task::SizeMismatchException, "Lazy expression")
+    }
+
     REPEAT(100)
     {
         auto rows = RandomUInt(1, 100), cols = RandomUInt(1, 100);
@@ -208,6 +472,412 @@ int main(int argc, char** argv) {
     }
 
 
+    {
+        constexpr auto rotation = task::Matrix3i::of(0, -1, 0, 1, 0, 0, 0, 0, 1);
+        constexpr auto scaling = task::Matrix3i() * 3;
+        static_assert((rotation * rotation.transposed()) == task::Matrix3i(), "FixedMatrix product");
+        static_assert((rotation * scaling).det() == 27, "FixedMatrix det");
+        static_assert(scaling.trace() == 9, "FixedMatrix trace");
+
+        auto mat1 = RandomMatrix(4, 4);
+        auto mat2 = RandomMatrix(4, 2);
+        task::Matrix4d fixed1(mat1);
+        task::FixedMatrix<double, 4, 2> fixed2(mat2);
+        ASSERT_TRUE_MSG((fixed1 * fixed2).toMatrix() == mat1 * mat2, "FixedMatrix operator *")
+        ASSERT_TRUE_MSG((fixed1 - fixed1 * 2.).toMatrix() == -mat1, "FixedMatrix arithmetic")
+        ASSERT_TRUE_MSG(fixed2.transposed().toMatrix() == mat2.transposed(), "FixedMatrix transposed()")
+        ASSERT_TRUE_MSG(fabs(fixed1.det() - mat1.det()) < EPS * 10., "FixedMatrix det()")
+        ASSERT_EXCEPTION_MSG(fixed1.get(4, 0), task::OutOfBoundsException, "FixedMatrix get()")
+        ASSERT_EXCEPTION_MSG(task::Matrix3d(mat1), task::SizeMismatchException, "FixedMatrix from Matrix")
+
+        // A tiny leading pivot: unpivoted elimination in float is off by more than 100%.
+        auto tinyPivot = task::Matrix3f::of(1e-7f, 1.f, 2.f, 1.f, 3.f, 4.f, 2.f, 5.f, 7.f);
+        ASSERT_TRUE_MSG(fabs(tinyPivot.det() + 1.) < 1e-5, "FixedMatrix pivoted det()")
+        static_assert(task::Matrix3l::of(0, 1, 0, 1, 0, 0, 0, 0, 2).det() == -2, "FixedMatrix int64 det");
+    }
+
+    {
+        // Small integers, so every float result below is exact.
+        Matrix mat1(5, 7), mat2(7, 3);
+        for (size_t i = 0; i < 7; ++i)
+            for (size_t j = 0; j < 5; ++j) {
+                mat1[j][i] = rand() % 21 - 10;
+                if (j < 3)
+                    mat2[i][j] = rand() % 21 - 10;
+            }
+        task::FloatMatrix float1(mat1);
+        task::FloatMatrix float2(mat2);
+        ASSERT_TRUE_MSG(task::Matrix(float1 * float2) == mat1 * mat2, "FloatMatrix operator *")
+        ASSERT_TRUE_MSG(task::Matrix(float1 - float1 * 2.f) == -mat1, "FloatMatrix arithmetic")
+        ASSERT_TRUE_MSG(task::Matrix(float1.transposed()) == mat1.transposed(), "FloatMatrix transposed()")
+        ASSERT_EXCEPTION_MSG(float1 + float2, task::SizeMismatchException, "FloatMatrix size mismatch")
+        ASSERT_EXCEPTION_MSG(float1.get(5, 0), task::OutOfBoundsException, "FloatMatrix get()")
+
+        task::FloatMatrix tinyPivot(3, 3);
+        const float values[] = {1e-7f, 1.f, 2.f, 1.f, 3.f, 4.f, 2.f, 5.f, 7.f};
+        std::copy(values, values + 9, tinyPivot.getData());
+        ASSERT_TRUE_MSG(fabs(tinyPivot.det() + 1.) < 1e-5, "FloatMatrix pivoted det()")
+
+        task::Int64Matrix integral(6, 6);
+        for (size_t i = 0; i < 6; ++i)
+            for (size_t j = 0; j < 6; ++j)
+                integral[i][j] = int64_t(rand() % 21) - 10;
+        const double expected = task::Matrix(integral).det();
+        ASSERT_TRUE_MSG(fabs(double(integral.det()) - expected) < 1e-6 * std::max(1., fabs(expected)), "Int64Matrix det()")
+        ASSERT_TRUE_MSG(integral.trace() == int64_t(task::Matrix(integral).trace()), "Int64Matrix trace()")
+        ASSERT_TRUE_MSG(integral * task::Int64Matrix(6, 6) == integral, "Int64Matrix identity product")
+        ASSERT_TRUE_MSG(2 * integral == integral + integral, "Int64Matrix scalar product")
+
+        task::Int32Matrix counts(2, 3);
+        counts[0][2] = 7;
+        std::stringstream stream;
+        stream << "2 3\n" << counts;
+        task::Int32Matrix parsed;
+        stream >> parsed;
+        ASSERT_TRUE_MSG(parsed == counts && parsed.getColumn(2) == std::vector<int32_t>({7, 0}), "Int32Matrix stream I/O")
+    }
+
+    for (size_t size : {64, 100, 129})
+    {
+        auto mat1 = RandomMatrix(size, size);
+        auto mat2 = RandomMatrix(size, size);
+
+        ASSERT_TRUE_MSG(task::gemm::getStrassenCutoff() == task::gemm::STRASSEN_OFF, "Strassen is opt-in")
+        auto classic = mat1 * mat2;
+        task::gemm::setStrassenCutoff(8);
+        auto fast = mat1 * mat2;
+        task::gemm::setStrassenCutoff(task::gemm::STRASSEN_OFF);
+
+        double error = 0.;
+        for (size_t i = 0; i < size; ++i)
+            for (size_t j = 0; j < size; ++j)
+                error = std::max(error, fabs(fast[i][j] - classic[i][j]) / std::max(1., fabs(classic[i][j])));
+        std::cout << "Strassen order " << size << ": relative error " << error << " against the classic kernel\n";
+        ASSERT_TRUE_MSG(error < EPS, "Strassen operator *: relative error " + std::to_string(error) +
+                                     " against the classic kernel for order " + std::to_string(size))
+    }
+
+    {
+        auto mat1 = RandomMatrix(30, 20);
+        Matrix mat2 = mat1;
+        const double* data = mat2.getData();
+
+        mat2.resize(10, 5);
+        ASSERT_TRUE_MSG(mat2.getData() == data && mat2.getColumnsCapacity() == 20, "Shrinking resize() keeps storage")
+        ASSERT_TRUE_MSG(mat2 == Matrix(mat1.getSubMatrixView(0, 0, 10, 5)), "Shrinking resize()")
+        mat2.resize(30, 20);
+        ASSERT_TRUE_MSG(mat2.getData() == data, "resize() within capacity keeps storage")
+        ASSERT_TRUE_MSG(mat2[9][4] == mat1[9][4] && mat2[9][5] == 0. && mat2[29][19] == 0., "resize() within capacity")
+
+        mat2.resize(30, 21);
+        ASSERT_TRUE_MSG(mat2.getColumnsCapacity() >= 40 && mat2[0][0] == mat1[0][0] && mat2[0][20] == 0., "Growing resize()")
+        data = mat2.getData();
+        for (size_t cols = 22; cols <= 40; ++cols)
+            mat2.resize(30, cols);
+        ASSERT_TRUE_MSG(mat2.getData() == data, "Growing resize() is amortized")
+
+        Matrix streamed(0, 0);
+        streamed.reserve(100, 8);
+        data = streamed.getData();
+        for (size_t i = 0; i < 100; ++i) {
+            streamed.resize(i + 1, 8);
+            streamed[i][7] = static_cast<double>(i);
+        }
+        ASSERT_TRUE_MSG(streamed.getData() == data && streamed[99][7] == 99. && streamed[42][0] == 0., "reserve()")
+        ASSERT_TRUE_MSG(streamed.getRowsCapacity() == 100, "reserve()")
+
+        mat2.shrinkToFit();
+        ASSERT_TRUE_MSG(mat2.getColumnsCapacity() == 40 && mat2.getRowsCapacity() == 30, "shrinkToFit()")
+        ASSERT_TRUE_MSG(mat2 * Matrix(40, 40) == mat2 && mat2.transposed().transposed() == mat2, "shrinkToFit()")
+    }
+
+    {
+        task::MatrixPool pool;
+        auto mat1 = RandomMatrix(RandomUInt(1, 100), RandomUInt(1, 100));
+        ASSERT_TRUE_MSG(reinterpret_cast<uintptr_t>(mat1.getData()) % task::MATRIX_ALIGNMENT == 0, "Aligned storage")
+
+        const double* recycled;
+        {
+            Matrix pooled(mat1, &pool);
+            ASSERT_TRUE_MSG(pooled == mat1 && pooled.getResource() == &pool, "Pooled copy")
+            ASSERT_TRUE_MSG(reinterpret_cast<uintptr_t>(pooled.getData()) % task::MATRIX_ALIGNMENT == 0, "Aligned storage")
+            recycled = pooled.getData();
+        }
+        ASSERT_TRUE_MSG(pool.getCachedBytes() >= mat1.getRowsCount() * mat1.getColumnsCount() * sizeof(double),
+                        "Pool keeps freed buffers")
+        Matrix reused(mat1.getRowsCount(), mat1.getColumnsCount(), &pool);
+        ASSERT_TRUE_MSG(reused.getData() == recycled && pool.getCachedBytes() == 0, "Pool recycles freed buffers")
+
+        const double* first;
+        const double* second;
+        {
+            Matrix one(8, 8, &pool), two(8, 8, &pool);
+            first = one.getData();
+            second = two.getData();
+        }
+        Matrix last(8, 8, &pool), previous(8, 8, &pool);
+        ASSERT_TRUE_MSG(last.getData() == first && previous.getData() == second && pool.getCachedBytes() == 0,
+                        "Pool free list is most recently freed first")
+
+        Matrix inPlace(mat1, &pool);
+        inPlace *= RandomMatrix(mat1.getColumnsCount(), mat1.getColumnsCount() + 3);
+        ASSERT_TRUE_MSG(inPlace.getResource() == &pool, "operator *= keeps the resource")
+        inPlace.transpose();
+        ASSERT_TRUE_MSG(inPlace.getResource() == &pool && inPlace.getRowsCount() == mat1.getColumnsCount() + 3,
+                        "Non-square transpose() keeps the resource")
+        task::FloatMatrix floatInPlace(3, 5, &pool);
+        floatInPlace *= task::FloatMatrix(5, 2);
+        floatInPlace.transpose();
+        ASSERT_TRUE_MSG(floatInPlace.getResource() == &pool, "BasicMatrix in-place operations keep the resource")
+
+        task::setDefaultMatrixResource(&pool);
+        auto sum = mat1 + mat1;
+        ASSERT_TRUE_MSG(sum.getResource() == &pool && sum == mat1 * 2., "Default resource")
+        Matrix moved = std::move(sum);
+        ASSERT_TRUE_MSG(moved.getResource() == &pool, "Move keeps the resource")
+        task::setDefaultMatrixResource(nullptr);
+        moved = RandomMatrix(3, 3) + RandomMatrix(3, 3);
+        ASSERT_TRUE_MSG(Matrix(moved).getResource() == std::pmr::new_delete_resource(), "Default resource")
+    }
+
+    REPEAT(10)
+    {
+        auto mat1 = RandomMatrix(RandomUInt(1, 100), RandomUInt(1, 100));
+
+        std::stringstream stream;
+        task::writeBinary(stream, mat1);
+        ASSERT_TRUE_MSG(task::readBinary(stream) == mat1, "Binary input / output")
+
+        const auto path = (std::filesystem::temp_directory_path() / ("task_matrix_" + std::to_string(RandomUInt()))).string();
+        {
+            std::ofstream file(path, std::ios::binary);
+            task::BinaryWriter writer(file, mat1.getRowsCount(), mat1.getColumnsCount());
+            for (size_t i = 0; i < mat1.getRowsCount(); ++i)
+                writer.writeRow(mat1.getRowView(i));
+            writer.finish();
+        }
+        {
+            task::MappedMatrix mapped(path);
+            const Matrix& view = mapped;
+            ASSERT_TRUE_MSG(view.getResource() == nullptr && view == mat1, "Memory-mapped matrix is used in place")
+            ASSERT_TRUE_MSG(view * Matrix(view.getColumnsCount(), view.getColumnsCount()) == mat1, "Memory-mapped operator *")
+            ASSERT_TRUE_MSG(view.transposed() == mat1.transposed(), "Memory-mapped transposed()")
+            task::MappedMatrix moved = std::move(mapped);
+            Matrix loaded = moved;
+            ASSERT_TRUE_MSG(loaded == mat1 && loaded.getResource() != nullptr, "Memory-mapped matrix copy")
+            if (mat1.getRowsCount() == mat1.getColumnsCount())
+                ASSERT_TRUE_MSG(fabs(moved.getMatrix().det() - mat1.det()) <= EPS * fabs(mat1.det()), "Memory-mapped det()")
+        }
+        std::remove(path.c_str());
+
+        // A header promising more rows than the stream holds fails before allocating them,
+        // whether or not the stream can seek.
+        std::string corrupt = stream.str();
+        const uint64_t hugeRows = uint64_t(1) << 40;
+        std::memcpy(&corrupt[16], &hugeRows, sizeof(hugeRows));
+        std::stringstream corruptStream(corrupt);
+        ASSERT_EXCEPTION_MSG(task::readBinary(corruptStream), task::MatrixFormatException, "Binary input with a corrupt header")
+        std::string valid = stream.str();
+        ForwardOnlyBuffer validBuffer(valid), corruptBuffer(corrupt);
+        std::istream validPipe(&validBuffer), corruptPipe(&corruptBuffer);
+        ASSERT_TRUE_MSG(task::readBinary(validPipe) == mat1, "Binary input from a stream that cannot seek")
+        ASSERT_EXCEPTION_MSG(task::readBinary(corruptPipe), task::MatrixFormatException, "Binary input with a corrupt header")
+
+        std::stringstream incomplete;
+        task::BinaryWriter writer(incomplete, 2, mat1.getColumnsCount());
+        writer.writeRow(mat1.getRowView(0));
+        ASSERT_EXCEPTION_MSG(writer.finish(), task::SizeMismatchException, "BinaryWriter::finish() with missing rows")
+        incomplete.setstate(std::ios::badbit);
+        ASSERT_EXCEPTION_MSG(writer.writeRow(mat1.getRowView(0)), std::ios_base::failure, "BinaryWriter on a failed stream")
+
+        std::stringstream broken("not a matrix at all, definitely not one with a header");
+        ASSERT_EXCEPTION_MSG(task::readBinary(broken), task::MatrixFormatException, "Binary input")
+    }
+
+    for (size_t threads : {1, 4}) {
+        task::parallel::setThreadsCount(threads);
+        const size_t count = RandomUInt(1, 70), rows = RandomUInt(1, 12), inner = RandomUInt(1, 12), cols = RandomUInt(1, 12);
+        task::MatrixBatch left(count, rows, inner), right(count, inner, cols), square(count, rows, rows);
+        std::vector<Matrix> lefts, rights, squares;
+        for (size_t i = 0; i < count; ++i) {
+            lefts.push_back(RandomMatrix(rows, inner));
+            rights.push_back(RandomMatrix(inner, cols));
+            squares.push_back(RandomMatrix(rows, rows));
+            if (i % 5 == 4)
+                squares.back()[0] = squares.back()[rows - 1];
+            left.setMatrix(i, lefts[i]);
+            right.setMatrix(i, rights[i]);
+            square.setMatrix(i, squares[i]);
+        }
+        auto products = task::batchedMultiply(left, right);
+        auto transposed = task::batchedTranspose(left);
+        auto dets = task::batchedDet(square);
+        ASSERT_TRUE_MSG(dets.size() == count && products.getCount() == count, "Batched operations")
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_TRUE_MSG(products.getMatrix(i) == lefts[i] * rights[i], "Batched multiply")
+            ASSERT_TRUE_MSG(transposed.getMatrix(i) == lefts[i].transposed(), "Batched transpose")
+            const double det = squares[i].det();
+            ASSERT_TRUE_MSG(std::abs(dets[i] - det) <= EPS * std::max(1., std::abs(det)), "Batched det")
+        }
+        ASSERT_EXCEPTION_MSG(task::batchedMultiply(left, task::MatrixBatch(count + 1, inner, cols)), task::SizeMismatchException, "Batched multiply")
+        ASSERT_EXCEPTION_MSG(task::batchedDet(task::MatrixBatch(count, rows, rows + 1)), task::SizeMismatchException, "Batched det")
+        ASSERT_EXCEPTION_MSG(left.get(count, 0, 0), task::OutOfBoundsException, "Batch get()")
+        task::MatrixBatch copy(left);
+        copy = square;
+        ASSERT_TRUE_MSG(copy.getMatrix(count - 1) == squares[count - 1], "Batch copy")
+    }
+    task::parallel::setThreadsCount(1);
+
+    for (size_t threads : {1, 4}) {
+        task::parallel::setThreadsCount(threads);
+        auto mat1 = RandomMatrix(RandomUInt(1, 20), RandomUInt(1, 20));
+        auto mat2 = RandomMatrix(300, 300);
+        mat2[7][7] = 1e-300;
+        mat2[8][8] = -0.1;
+        for (const Matrix* source : {&mat1, &mat2}) {
+            std::stringstream stream;
+            task::writeText(stream, *source);
+            const std::string text = stream.str() + "  tail";
+            size_t consumed;
+            Matrix parsed = task::parseText(text, &consumed);
+            bool exact = parsed.getRowsCount() == source->getRowsCount() &&
+                         parsed.getColumnsCount() == source->getColumnsCount();
+            for (size_t i = 0; exact && i < parsed.getRowsCount(); ++i)
+                for (size_t j = 0; j < parsed.getColumnsCount(); ++j)
+                    exact = exact && parsed.get(i, j) == source->get(i, j);
+            ASSERT_TRUE_MSG(exact, "Text round trip")
+            ASSERT_TRUE_MSG(text.substr(consumed) == " \n  tail", "Text round trip")
+
+            Matrix streamed;
+            std::stringstream(text) >> streamed;
+            ASSERT_TRUE_MSG(streamed == *source, "Text round trip")
+        }
+        std::stringstream plus("2 1\n+1.5 -2e3");
+        Matrix column = task::readText(plus);
+        ASSERT_TRUE_MSG(column.getRowsCount() == 2 && column[0][0] == 1.5 && column[1][0] == -2000., "Text input")
+        ASSERT_EXCEPTION_MSG(task::parseText("2 2 1 2 3"), task::MatrixFormatException, "Short text input")
+        ASSERT_EXCEPTION_MSG(task::parseText("1 2 1 2x"), task::MatrixFormatException, "Malformed text input")
+        Matrix broken;
+        std::stringstream malformed("1 2 1 oops");
+        malformed >> broken;
+        ASSERT_TRUE_MSG(malformed.fail(), "Malformed text input")
+
+        // Longer than one read batch, from a seekable stream and from a pipe.
+        auto large = RandomMatrix(500, 500);
+        std::stringstream largeStream;
+        task::writeText(largeStream, large);
+        std::string largeText = largeStream.str();
+        ASSERT_TRUE_MSG(task::readText(largeStream) == large, "Batched text input")
+        ForwardOnlyBuffer largeBuffer(largeText);
+        std::istream largePipe(&largeBuffer);
+        ASSERT_TRUE_MSG(task::readText(largePipe) == large, "Batched text input from a pipe")
+    }
+    task::parallel::setThreadsCount(1);
+
+    {
+        // Rows longer than one write batch are formatted in column slices.
+        auto wide = RandomMatrix(2, 200000);
+        std::stringstream stream;
+        task::writeText(stream, wide);
+        ASSERT_TRUE_MSG(task::parseText(stream.str()) == wide, "Wide text output")
+
+        // Lying headers fail on the text instead of allocating for the claimed size.
+        ASSERT_EXCEPTION_MSG(task::parseText("1000000 1000000 1 2 3"), task::MatrixFormatException, "Text header size")
+        std::stringstream seekable("1000000 1000000 1 2 3");
+        ASSERT_EXCEPTION_MSG(task::readText(seekable), task::MatrixFormatException, "Text header size")
+        std::string lie = "100000 100000 1 2 3";
+        ForwardOnlyBuffer lieBuffer(lie);
+        std::istream liePipe(&lieBuffer);
+        ASSERT_EXCEPTION_MSG(task::readText(liePipe), task::MatrixFormatException, "Text header size from a pipe")
+
+        // Numerals longer than the stack token of operator>>.
+        std::stringstream longNumerals("1 2\n" + std::string(200, '0') + "1.5 0." + std::string(300, '0') + "1e300\n");
+        Matrix parsed;
+        longNumerals >> parsed;
+        ASSERT_TRUE_MSG(!longNumerals.fail() && parsed[0][0] == 1.5 && fabs(parsed[0][1] - 1e-1) < EPS, "Long numerals")
+    }
+
+    REPEAT(10)
+    {
+        auto rows = RandomUInt(1, 60), cols = RandomUInt(1, 60);
+        auto mat1 = RandomMatrix(rows, cols);
+        auto mat2 = RandomMatrix(rows, cols);
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t j = 0; j < cols; ++j) {
+                if (RandomUInt(9) != 0)
+                    mat1[i][j] = 0.;
+                if (RandomUInt(9) != 0)
+                    mat2[i][j] = 0.;
+            }
+        auto dense = RandomMatrix(cols, RandomUInt(1, 20));
+        std::vector<double> vector(cols);
+        for (double& value : vector)
+            value = RandomDouble();
+
+        task::CsrMatrix csr(mat1);
+        task::CscMatrix csc(mat1);
+        ASSERT_TRUE_MSG(csr.toMatrix() == mat1 && csc.toMatrix() == mat1, "Sparse from / to Matrix")
+        ASSERT_TRUE_MSG(task::CsrMatrix(csc) == csr && csr.toCsc() == csc, "Sparse CSR / CSC conversion")
+
+        auto expected = mat1 * dense;
+        ASSERT_TRUE_MSG(csr * dense == expected, "Sparse CSR SpMM")
+        ASSERT_TRUE_MSG(csc * dense == expected, "Sparse CSC SpMM")
+
+        auto csrProduct = csr * vector, cscProduct = csc * vector;
+        for (size_t i = 0; i < rows; ++i) {
+            double sum = 0.;
+            for (size_t j = 0; j < cols; ++j)
+                sum += mat1[i][j] * vector[j];
+            ASSERT_TRUE_MSG(fabs(csrProduct[i] - sum) < EPS && fabs(cscProduct[i] - sum) < EPS, "Sparse SpMV")
+        }
+
+        task::parallel::setThreadsCount(4);
+        task::parallel::setGrainSize(16);
+        ASSERT_TRUE_MSG(csr * vector == csrProduct, "Sparse parallel SpMV")
+        ASSERT_TRUE_MSG(csr * dense == expected && csc * dense == expected, "Sparse parallel SpMM")
+        task::parallel::setThreadsCount(1);
+        task::parallel::setGrainSize(1 << 16);
+
+        ASSERT_TRUE_MSG((csr + task::CsrMatrix(mat2)).toMatrix() == mat1 + mat2, "Sparse operator +")
+        ASSERT_TRUE_MSG((csc - task::CscMatrix(mat2)).toMatrix() == mat1 - mat2, "Sparse operator -")
+        ASSERT_TRUE_MSG((csr - csr).getNonZerosCount() == 0, "Sparse operator -")
+        ASSERT_TRUE_MSG(csr.transposed().toMatrix() == mat1.transposed(), "Sparse transposed()")
+        ASSERT_TRUE_MSG(csc.transposed().toMatrix() == mat1.transposed(), "Sparse transposed()")
+        ASSERT_EXCEPTION_MSG(csr.get(rows, 0), task::OutOfBoundsException, "Sparse get()")
+        ASSERT_EXCEPTION_MSG(csr + task::CsrMatrix(rows + 1, cols), task::SizeMismatchException, "Sparse operator +")
+
+        std::stringstream stream;
+        stream.precision(17);
+        stream << csr;
+        task::CsrMatrix loaded;
+        Matrix loadedDense;
+        stream >> task::coo >> loaded;
+        ASSERT_TRUE_MSG(loaded == csr, "Sparse COO input / output")
+        stream.clear();
+        stream.seekg(0);
+        stream >> loadedDense >> task::dense;
+        ASSERT_TRUE_MSG(loadedDense == mat1, "Matrix COO input")
+    }
+
+    {
+        std::stringstream stream("3 2 3\n0 1 1.5\n2 0 -2\n0 1 1.5\n");
+        Matrix mat;
+        stream >> task::coo >> mat;
+        ASSERT_TRUE_MSG(mat.getRowsCount() == 3 && mat.getColumnsCount() == 2, "Matrix COO input")
+        ASSERT_TRUE_MSG(mat[0][1] == 3. && mat[2][0] == -2. && mat[0][0] == 0. && mat[1][1] == 0., "Matrix COO input")
+        std::stringstream broken("2 2 1\n2 0 1\n");
+        ASSERT_EXCEPTION_MSG(broken >> task::coo >> mat, task::OutOfBoundsException, "Matrix COO input")
+
+        // A lying count fails on the missing triplets instead of allocating for all of them.
+        std::stringstream truncated("4 4 1000000000000\n0 1 1.5\n");
+        task::CsrMatrix sparse;
+        truncated >> task::coo >> sparse;
+        ASSERT_TRUE_MSG(truncated.fail() && sparse.getRowsCount() == 0, "Sparse COO input count")
+
+        Matrix empty = Matrix::zeros(3, 4);
+        ASSERT_TRUE_MSG(empty.getRowsCount() == 3 && empty == Matrix(3, 4) * 0., "Matrix::zeros()")
+    }
+
     const int STRESS_TEST_COUNT = argc > 1 ? std::stoi(argv[1]) : 0;
 
     REPEAT(STRESS_TEST_COUNT)